@@ -0,0 +1,349 @@
+/**
+ * Projet Canvascii - Mesures de performance des primitives
+ *
+ * Ce programme, bench.c, chronomètre les primitives de canvascii.c
+ * (création, lecture, impression, impression colorée et tracé de
+ * segments, cercles et rectangles) sur plusieurs tailles de canevas et
+ * densités de formes. Il inclut canvascii.c, dont le main est renommé,
+ * et est lié à libcanvascii.a pour appeler directement leurs fonctions.
+ *
+ * Usage:
+ *  ./canvascii_bench [SECONDES]
+ *
+ * Chaque mesure est répétée jusqu'à durer au moins SECONDES (0.2 par
+ * défaut). Les résultats sont imprimés sur stdout en CSV, une ligne par
+ * mesure :
+ *  fonction,hauteur,largeur,formes,pixels,octets,iterations,ns_par_pixel,mo_par_s
+ * où pixels et octets sont traités par itération : pixels du canevas pour
+ * la création et les entrées-sorties, pixels distincts couverts par les
+ * formes pour les tracés; octets lus ou écrits pour les entrées-sorties,
+ * un octet par pixel sinon.
+ *
+ */
+
+#define main canvascii_main
+#include "canvascii.c"
+#undef main
+
+#define DUREE_MIN_DEFAUT 0.2      // Durée minimale d'une mesure, en secondes
+#define GRAINE_FORMES 12345u      // Graine des formes aléatoires, pour des mesures reproductibles
+#define NOMBRE_TAILLES 3
+#define NOMBRE_DENSITES 2
+
+// Tailles des canevas mesurés, en rangées et colonnes
+const unsigned int TAILLES[NOMBRE_TAILLES][2] = {{40, 80}, {1000, 1000}, {4000, 4000}};
+
+// Nombres de formes tracées par itération
+const unsigned int DENSITES[NOMBRE_DENSITES] = {10, 1000};
+
+typedef struct {
+    unsigned long iterations;   // Nombre de répétitions mesurées
+    double secondes;            // Durée totale des répétitions
+} Mesure;
+
+typedef struct Travail Travail;
+
+struct Travail {
+    const char *fonction;       // Nom de la fonction mesurée, pour le rapport
+    void (*executer)(Travail *travail);
+    struct canvas *canvas;
+    FILE *flux;                 // Destination des impressions
+    enum type_commande forme;   // Type des formes générées pour un tracé
+    const ListeCommandes *formes; // Formes tracées à chaque itération
+    size_t octets;              // Octets produits par la dernière itération
+};
+
+/**
+ * tirer - Tire un entier pseudo-aléatoire dans [0, borne).
+ *
+ * Générateur congruentiel linéaire, identique d'une plateforme à l'autre.
+ *
+ * @param etat Pointeur vers l'état du générateur.
+ * @param borne Borne supérieure (exclue), non nulle.
+ * @return int L'entier tiré.
+ */
+int tirer(unsigned int *etat, unsigned int borne) {
+    *etat = *etat * 1103515245u + 12345u;
+    return (*etat >> 8) % borne;
+}
+
+/**
+ * generer_formes - Génère des formes aléatoires contenues dans un canevas.
+ *
+ * Les rectangles mesurent au plus le quart du canevas dans chaque
+ * dimension et les cercles ont un rayon d'au plus le huitième du plus
+ * petit côté.
+ *
+ * @param formes Pointeur vers la liste à remplir, vide.
+ * @param type COMMANDE_SEGMENT, COMMANDE_CERCLE ou COMMANDE_RECTANGLE.
+ * @param nombre Nombre de formes.
+ * @param hauteur Hauteur du canevas.
+ * @param largeur Largeur du canevas.
+ */
+void generer_formes(ListeCommandes *formes, enum type_commande type, unsigned int nombre,
+                    unsigned int hauteur, unsigned int largeur) {
+    unsigned int etat = GRAINE_FORMES;
+    unsigned int cote = hauteur < largeur ? hauteur : largeur;
+
+    for (unsigned int i = 0; i < nombre; i++) {
+        Commande commande = {.type = type};
+
+        if (type == COMMANDE_SEGMENT) {
+            commande.parametres.segment = (Segment) {
+                {tirer(&etat, hauteur), tirer(&etat, largeur)},
+                {tirer(&etat, hauteur), tirer(&etat, largeur)}
+            };
+        } else if (type == COMMANDE_CERCLE) {
+            int rayon = tirer(&etat, cote / 8) + 1;
+            commande.parametres.cercle = (Cercle) {
+                rayon + tirer(&etat, hauteur - 2 * rayon), rayon + tirer(&etat, largeur - 2 * rayon), rayon
+            };
+        } else {
+            int rangees = tirer(&etat, hauteur / 4) + 2;
+            int colonnes = tirer(&etat, largeur / 4) + 2;
+            commande.parametres.rectangle = (Rectangle) {
+                {tirer(&etat, largeur - colonnes), tirer(&etat, hauteur - rangees)}, rangees, colonnes
+            };
+        }
+        ajouter_commande(formes, commande);
+    }
+}
+
+/**
+ * tracer_formes - Trace toutes les formes d'une liste sur un canevas.
+ *
+ * @param formes Pointeur vers la liste de formes.
+ * @param canvas Pointeur vers le canevas.
+ */
+void tracer_formes(const ListeCommandes *formes, struct canvas *canvas) {
+    Fenetre fenetre = fenetre_canvas(canvas);
+
+    for (size_t i = 0; i < formes->nombre; i++) {
+        appliquer_commande(canvas, &formes->commandes[i], &fenetre);
+    }
+}
+
+/**
+ * compter_pixels_couverts - Compte les pixels distincts couverts par des formes.
+ *
+ * Trace les formes sur un canevas vide de mêmes dimensions et compte les
+ * pixels qui ne sont plus '.'.
+ *
+ * @param formes Pointeur vers la liste de formes.
+ * @param hauteur Hauteur du canevas.
+ * @param largeur Largeur du canevas.
+ * @return size_t Nombre de pixels couverts.
+ */
+size_t compter_pixels_couverts(const ListeCommandes *formes, unsigned int hauteur, unsigned int largeur) {
+    struct canvas canvas = {.height = hauteur, .width = largeur};
+    size_t couverts = 0;
+
+    creer_canvas(&canvas, '7');
+    tracer_formes(formes, &canvas);
+    for (unsigned int rangee = 0; rangee < hauteur; rangee++) {
+        const char *pixels = rangee_canvas(&canvas, rangee);
+        for (unsigned int colonne = 0; colonne < largeur; colonne++) couverts += pixels[colonne] != '.';
+    }
+    liberer_canvas(&canvas);
+    return couverts;
+}
+
+/**
+ * executer_creation - Itération de creer_canvas, suivie de la libération.
+ *
+ * @param travail Pointeur vers le travail, dont le canevas donne les dimensions.
+ */
+void executer_creation(Travail *travail) {
+    struct canvas nouveau = {.height = travail->canvas->height, .width = travail->canvas->width};
+
+    creer_canvas(&nouveau, '7');
+    liberer_canvas(&nouveau);
+}
+
+/**
+ * executer_lecture - Itération de lire_canvas_de_stdin, suivie de la libération.
+ *
+ * @param travail Pointeur vers le travail; stdin est un fichier rembobiné
+ * à chaque itération.
+ */
+void executer_lecture(Travail *travail) {
+    struct canvas lu = {0};
+
+    (void) travail;
+    fseek(stdin, 0, SEEK_SET);
+    lire_canvas_de_stdin(&lu);
+    liberer_canvas(&lu);
+}
+
+/**
+ * executer_impression - Itération de imprimer_canvas.
+ *
+ * @param travail Pointeur vers le travail; octets reçoit les octets écrits.
+ */
+void executer_impression(Travail *travail) {
+    travail->octets = imprimer_canvas(travail->canvas, travail->flux);
+}
+
+/**
+ * executer_impression_couleur - Itération de imprimer_canvas_couleur.
+ *
+ * @param travail Pointeur vers le travail; octets reçoit les octets écrits.
+ */
+void executer_impression_couleur(Travail *travail) {
+    travail->octets = imprimer_canvas_couleur(travail->canvas, travail->flux);
+}
+
+/**
+ * executer_trace - Itération du tracé de toutes les formes du travail.
+ *
+ * @param travail Pointeur vers le travail.
+ */
+void executer_trace(Travail *travail) {
+    tracer_formes(travail->formes, travail->canvas);
+}
+
+/**
+ * mesurer - Répète un travail jusqu'à atteindre une durée minimale.
+ *
+ * Une première itération, non comptée, met les caches et les pages en
+ * place.
+ *
+ * @param travail Pointeur vers le travail à mesurer.
+ * @param duree_min Durée minimale de la mesure, en secondes.
+ * @return Mesure Nombre d'itérations et durée totale.
+ */
+Mesure mesurer(Travail *travail, double duree_min) {
+    Mesure mesure = {0, 0};
+    struct timespec debut;
+
+    travail->executer(travail);
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    do {
+        travail->executer(travail);
+        mesure.iterations++;
+        mesure.secondes = secondes_ecoulees(&debut);
+    } while (mesure.secondes < duree_min);
+    return mesure;
+}
+
+/**
+ * rapporter - Imprime une ligne CSV de résultats.
+ *
+ * @param fonction Nom de la fonction mesurée.
+ * @param canvas Pointeur vers le canevas, pour ses dimensions.
+ * @param formes Nombre de formes par itération, 0 hors tracé.
+ * @param pixels Pixels traités par itération.
+ * @param octets Octets traités par itération.
+ * @param mesure Mesure obtenue.
+ */
+void rapporter(const char *fonction, const struct canvas *canvas, unsigned int formes,
+               size_t pixels, size_t octets, Mesure mesure) {
+    double par_iteration = mesure.secondes / mesure.iterations;
+
+    printf("%s,%u,%u,%u,%zu,%zu,%lu,%.3f,%.1f\n", fonction, canvas->height, canvas->width, formes,
+           pixels, octets, mesure.iterations, par_iteration * 1e9 / pixels, octets / par_iteration / 1e6);
+    fflush(stdout);
+}
+
+/**
+ * preparer_stdin - Place un canevas texte dans un fichier temporaire lu sur stdin.
+ *
+ * @param canvas Pointeur vers le canevas à écrire.
+ * @return size_t Taille du texte, en octets.
+ */
+size_t preparer_stdin(struct canvas *canvas) {
+    FILE *fichier = tmpfile();
+
+    if (fichier == NULL) {
+        perror("tmpfile");
+        exit(EXIT_FAILURE);
+    }
+    size_t octets = imprimer_canvas(canvas, fichier);
+    fflush(fichier);
+    dup2(fileno(fichier), STDIN_FILENO);
+    fclose(fichier);
+    return octets;
+}
+
+/**
+ * mesurer_taille - Mesure toutes les primitives sur un canevas d'une taille.
+ *
+ * Le canevas mesuré est celui de examples/all-pens5x8.canvas répété, pour
+ * que l'impression colorée change de couleur comme sur un vrai dessin.
+ *
+ * @param hauteur Hauteur du canevas.
+ * @param largeur Largeur du canevas.
+ * @param duree_min Durée minimale de chaque mesure, en secondes.
+ */
+void mesurer_taille(unsigned int hauteur, unsigned int largeur, double duree_min) {
+    const char *motif[] = {"...7....", ".0..2.1.", "...3....", ".4...5..", "...6...."};
+    Travail entrees_sorties[] = {
+        {.fonction = "creer_canvas", .executer = executer_creation},
+        {.fonction = "lire_canvas_de_stdin", .executer = executer_lecture},
+        {.fonction = "imprimer_canvas", .executer = executer_impression},
+        {.fonction = "imprimer_canvas_couleur", .executer = executer_impression_couleur}
+    };
+    Travail traces[] = {
+        {.fonction = "tracer_segment", .executer = executer_trace, .forme = COMMANDE_SEGMENT},
+        {.fonction = "tracer_cercle", .executer = executer_trace, .forme = COMMANDE_CERCLE},
+        {.fonction = "tracer_rectangle", .executer = executer_trace, .forme = COMMANDE_RECTANGLE}
+    };
+    struct canvas canvas = {.height = hauteur, .width = largeur};
+    size_t pixels = (size_t) hauteur * largeur;
+    FILE *nul = fopen("/dev/null", "w");
+
+    if (nul == NULL) {
+        perror("/dev/null");
+        exit(EXIT_FAILURE);
+    }
+    creer_canvas(&canvas, '7');
+    for (unsigned int rangee = 0; rangee < hauteur; rangee++) {
+        char *pixels_rangee = rangee_canvas(&canvas, rangee);
+        for (unsigned int colonne = 0; colonne < largeur; colonne++) {
+            pixels_rangee[colonne] = motif[rangee % 5][colonne % 8];
+        }
+    }
+    size_t octets_texte = preparer_stdin(&canvas);
+
+    for (size_t i = 0; i < sizeof(entrees_sorties) / sizeof(entrees_sorties[0]); i++) {
+        Travail *travail = &entrees_sorties[i];
+        travail->canvas = &canvas;
+        travail->flux = nul;
+
+        Mesure mesure = mesurer(travail, duree_min);
+        size_t octets = travail->octets != 0 ? travail->octets : i == 0 ? pixels : octets_texte;
+        rapporter(travail->fonction, &canvas, 0, pixels, octets, mesure);
+    }
+
+    for (size_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        for (int d = 0; d < NOMBRE_DENSITES; d++) {
+            ListeCommandes formes = {0};
+            Travail travail = traces[i];
+
+            generer_formes(&formes, travail.forme, DENSITES[d], hauteur, largeur);
+            travail.canvas = &canvas;
+            travail.formes = &formes;
+
+            size_t couverts = compter_pixels_couverts(&formes, hauteur, largeur);
+            Mesure mesure = mesurer(&travail, duree_min);
+            rapporter(travail.fonction, &canvas, DENSITES[d], couverts, couverts, mesure);
+            liberer_commandes(&formes);
+        }
+    }
+    fclose(nul);
+    liberer_canvas(&canvas);
+}
+
+/**
+ * Point d'entrée des mesures. Imprime l'en-tête CSV puis une ligne par
+ * fonction, taille et densité.
+ */
+int main(int argc, char *argv[]) {
+    double duree_min = argc > 1 ? atof(argv[1]) : DUREE_MIN_DEFAUT;
+
+    printf("fonction,hauteur,largeur,formes,pixels,octets,iterations,ns_par_pixel,mo_par_s\n");
+    for (int i = 0; i < NOMBRE_TAILLES; i++) {
+        mesurer_taille(TAILLES[i][0], TAILLES[i][1], duree_min);
+    }
+    return OK;
+}
@@ -3,20 +3,49 @@
  *
  * Ce programme, canvascii.c, permet de créer et de manipuler des dessins sur un canevas ASCII en utilisant
  * diverses options pour dessiner des formes géométriques, ajuster les couleurs et gérer les dimensions du canevas.
+ * Le dessin lui-même est confié à la bibliothèque libcanvascii (libcanvascii.c, canvascii.h); ce fichier
+ * analyse la ligne de commande, signale les erreurs et exécute les scripts, l'animation et le serveur de rendu.
  *
  *
  * Usage:
  *  ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]
- *              [-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]
- *              [-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]
+ *              [-u] [-f FILE] [-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]
+ *              [-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS] [-w WIDTH]
+ *              [-R ROW,COL,HEIGHT,WIDTH] [-C ROW,COL,RADIUS] [-F ROW,COL]
+ *              [-L ROW1,COL1,...] [-P ROW1,COL1,...] [-A ROW1,COL1,...]
+ *              [--tiled] [--packed] [-j N] [--incremental] [--fps N]
+ *              [-i FILE] [-o FILE] [--rle] [--stats]
+ *              [--compile FILE] [--run FILE]
+ *              [--serve SOCKET] [--client SOCKET]
  *
  * Options:
  *  -n Crée un nouveau canevas vide.
  *  -s Affiche le canevas et termine le programme.
  *  -k Active la sortie colorée.
+ *  -u Lève la limite de 40x80 sur les dimensions du canevas.
+ *  -i Charge un canevas binaire, projeté en mémoire, plutôt que de le lire sur stdin.
+ *  -o Enregistre le canevas en binaire plutôt que de l'imprimer.
+ *  --rle Imprime le canevas encodé par plages; ce format est aussi reconnu sur stdin.
+ *  --stats Rapporte sur stderr la durée de chaque phase, les pixels écrits et les octets lus et écrits.
+ *  --tiled Stocke les pixels par tuiles de 64x64 plutôt que par rangées.
+ *  --packed Stocke chaque pixel sur 4 bits plutôt que sur un octet.
+ *  -j Répartit le rendu entre N threads, une bande horizontale du canevas par thread,
+ *    ainsi que le formatage de la sortie.
  *  -p Définit le style du crayon utilisé pour le dessin.
+ *  -w Définit l'épaisseur des rectangles, segments, cercles et lignes brisées tracés ensuite.
  *  -h, -v, -r, -l, -c Dessinent respectivement une ligne horizontale, verticale, un rectangle, une ligne
  *    discrète et un cercle, selon les paramètres spécifiés.
+ *  -R, -C Dessinent respectivement un rectangle plein et un disque plein.
+ *  -F Remplit la zone de même couleur autour d'un pixel.
+ *  -L, -P, -A Dessinent respectivement une ligne brisée, le contour d'un polygone et un polygone plein
+ *    à partir de la liste de leurs sommets.
+ *  -f Applique les commandes de dessin d'un fichier script.
+ *  --compile Enregistre les commandes de dessin, scripts compris, en programme compilé sans dessiner.
+ *  --run Rejoue un programme compilé, sans analyse.
+ *  --incremental Ne réaffiche que les pixels modifiés depuis l'image précédente.
+ *  --fps Émet les images des scripts à une cadence fixe et abandonne celles en retard.
+ *  --serve Exécute un serveur de rendu sur un socket Unix, avec des canevas résidents.
+ *  --client Envoie des requêtes à un serveur de rendu.
  *
  * Auteur : Églantine Clervil (CLEE89530109)
  * Date de création : Le dimanche 2 juin 2024
@@ -24,61 +53,133 @@
  */
 
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "canvascii_interne.h"
+
+#define TAILLE_NOM_CANEVAS 64             // Longueur maximale du nom d'un canevas résident
+#define MAX_JETONS_REQUETE 128            // Nombre maximal de mots dans une requête
+#define TAILLE_MAX_REQUETE (64 * 1024 * 1024) // Longueur maximale d'une ligne de requête
+#define SEUIL_SORTIE_CLIENT (1024 * 1024) // Réponses en attente au-delà desquelles on cesse de lire
+#define TAILLE_LOT_PARALLELE 65536        // Commandes de script rendues par lot avec -j
+#define MAX_IMAGES_PAR_SECONDE 1000       // Cadence maximale de --fps
+
+#define USAGE_ABREGE "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n" \
+                     "\t[-u] [-f FILE] [-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n" \
+                     "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS] [-w WIDTH]\n" \
+                     "\t[-R ROW,COL,HEIGHT,WIDTH] [-C ROW,COL,RADIUS] [-F ROW,COL]\n" \
+                     "\t[-L ROW1,COL1,...] [-P ROW1,COL1,...] [-A ROW1,COL1,...]\n" \
+                     "\t[--tiled] [--packed] [-j N] [--incremental] [--fps N]\n" \
+                     "\t[-i FILE] [-o FILE] [--rle] [--stats]\n" \
+                     "\t[--compile FILE] [--run FILE]\n" \
+                     "\t[--serve SOCKET] [--client SOCKET]\n"
 
-#define MAX_HEIGHT 40
-#define MAX_WIDTH 80
+typedef struct {
+    Commande *commandes;
+    size_t nombre;
+    size_t capacite;
+} ListeCommandes;
 
-struct canvas {
-    char pixels[MAX_HEIGHT][MAX_WIDTH]; // A matrix of pixels
-    unsigned int width;                 // Its width
-    unsigned int height;                // Its height
-    char pen;                           // The character we are drawing with
-};
+typedef struct {
+    struct timespec debut;          // Instant de la première image
+    double prochaine;               // Échéance de la prochaine image, en secondes depuis debut
+    double fin_ecriture;            // Fin de l'écriture de l'image précédente, depuis debut
+    unsigned long abandonnees;      // Images abandonnées parce qu'en retard
+    double latence_totale;          // Somme des latences des images émises, en secondes
+    double latence_max;             // Plus grande latence d'une image émise
+} Cadence;
 
-enum error {
-    OK                         = 0, // Everything is ok
-    ERR_WRONG_PIXEL            = 1, // Wrong pixel value in canvas
-    ERR_CANVAS_TOO_HIGH        = 2, // Canvas is too high
-    ERR_CANVAS_TOO_WIDE        = 3, // Canvas is too wide
-    ERR_CANVAS_NON_RECTANGULAR = 4, // Canvas is non rectangular
-    ERR_UNRECOGNIZED_OPTION    = 5, // Unrecognized option
-    ERR_MISSING_VALUE          = 6, // Option with missing value
-    ERR_WITH_VALUE             = 7  // Problem with value
-};
+typedef struct {
+    unsigned int actives;           // Statistiques imprimées sur stderr (--stats)
+    struct timespec debut_phase;    // Début de la phase en cours
+    CompteurTrace traces[COMMANDE_SCRIPT]; // Commandes et pixels par type de commande
+    unsigned long long octets_lus;  // Canevas et scripts lus
+    unsigned long long octets_ecrits; // Images imprimées et canevas enregistré
+    size_t memoire_max;             // Plus grande mémoire occupée par le canevas
+} Statistiques;
 
 typedef struct {
-    int x;
-    int y;
-} Coordonnees;
+    unsigned int option_n_present;  // Le canevas est créé plutôt que lu sur stdin
+    char *fichier_entree;           // Canevas binaire à charger plutôt que stdin (-i)
+    char *fichier_sortie;           // Canevas binaire à enregistrer plutôt qu'imprimé (-o)
+    struct canvas dimensions;       // Dimensions demandées par -n
+    unsigned int illimite;          // Dimensions non bornées à 40x80 (-u)
+    unsigned int sortie_couleur;    // Impression avec les couleurs ANSI (-k)
+    unsigned int sortie_rle;        // Impression encodée par plages (--rle)
+    unsigned int par_tuiles;        // Pixels stockés par tuiles (--tiled)
+    unsigned int compacte;          // Pixels stockés sur 4 bits (--packed)
+    unsigned int nombre_threads;    // Threads de rendu par bandes (-j)
+    unsigned int incrementale;      // Réaffichage des seuls pixels modifiés (--incremental)
+    unsigned int images_emises;     // Images déjà émises sur stdout
+    unsigned int images_par_seconde; // Cadence des images (--fps), 0 pour émettre sans attendre
+    Cadence cadence;                // État de la cadence et mesures de latence
+    Statistiques statistiques;      // Durées des phases et compteurs (--stats)
+    ListeCommandes commandes;       // Commandes de dessin, dans l'ordre d'apparition
+    char *programme_compile;        // Programme à écrire plutôt que de dessiner (--compile)
+    char *socket_serveur;           // Chemin du socket à servir (--serve)
+    char *socket_client;            // Chemin du socket d'un serveur (--client)
+} Configuration;
 
 typedef struct {
-    Coordonnees position;      
-    unsigned int height;
-    unsigned int width;
-} Rectangle;
+    char nom[TAILLE_NOM_CANEVAS + 1];
+    struct canvas canvas;
+} CanevasResident;
 
 typedef struct {
-    Coordonnees pointA;
-    Coordonnees pointB;
-} Segment;
+    int descripteur;            // Socket de la connexion
+    char *entree;               // Octets reçus, pas encore traités
+    size_t taille_entree;
+    size_t capacite_entree;
+    char *sortie;               // Réponses en attente d'envoi
+    size_t taille_sortie;
+    size_t capacite_sortie;
+    size_t octets_envoyes;      // Octets de sortie déjà envoyés
+    int fin_entree;             // Le client a fermé son côté de la connexion
+    int fermeture;              // Fermer dès que les réponses sont envoyées
+    int chargement;             // Une requête load attend ses rangées
+    char nom_charge[TAILLE_NOM_CANEVAS + 1];
+    struct canvas canvas_charge;
+    LecteurCanvas lecteur;
+    enum error erreur_chargement; // Première erreur des rangées reçues
+} ClientServeur;
 
 typedef struct {
-    int ROW;
-    int COL;
-    unsigned int rayon;
-} Cercle;
+    int ecoute;                 // Socket d'écoute
+    CanevasResident *canevas;   // Canevas résidents, partagés par les clients
+    size_t nombre_canevas;
+    size_t capacite_canevas;
+    ClientServeur **clients;
+    size_t nombre_clients;
+    size_t capacite_clients;
+    struct pollfd *attentes;    // Descripteurs surveillés par poll, un de plus que de clients
+    int limitee;                // Canevas bornés à 40x80 (sans -u)
+} Serveur;
+
+// Demande d'arrêt du serveur, levée par SIGINT ou SIGTERM
+volatile sig_atomic_t arret_serveur = 0;
 
 void afficher_manuel_utilisation(void) {
-    printf("Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-               "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-               "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+    printf(USAGE_ABREGE
                "Draws on an ASCII canvas. The canvas is provided on stdin and\n"
                "the result is printed on stdout. The dimensions of the canvas\n"
-               "are limited to at most 40 rows and at most 80 columns.\n\n"
+               "are limited to at most 40 rows and at most 80 columns, unless\n"
+               "option -u is given.\n\n"
                "If no argument is provided, the program prints this help and exit.\n\n"
                "Canvas options:\n"
                "  -n HEIGHT,WIDTH           Creates a new empty canvas of HEIGHT rows and\n"
@@ -86,15 +187,58 @@ void afficher_manuel_utilisation(void) {
                "                            otherwise, the behavior is undefined.\n"
                "                            Ignores stdin.\n"
                "  -s                        Shows the canvas and exit.\n"
+               "  -i FILE                   Loads the canvas from the binary FILE,\n"
+               "                            mapped in memory, instead of stdin. Its\n"
+               "                            layout is kept.\n"
+               "  -o FILE                   Saves the canvas to the binary FILE, in its\n"
+               "                            layout, instead of printing it.\n"
+               "  --rle                     Prints the canvas run-length encoded: a\n"
+               "                            \"RLE HEIGHT,WIDTH\" line, then one line of\n"
+               "                            space-separated runs per row, such as\n"
+               "                            \"12. 7 3.\" (a count may precede each\n"
+               "                            pixel). Ignores -k. A canvas in this format\n"
+               "                            is recognized on stdin; its rows are\n"
+               "                            decoded only when drawn on or printed.\n"
+               "  -u                        Lifts the 40x80 limit on the dimensions\n"
+               "                            of the canvas.\n"
                "  -k                        Enables colored output. Replaces characters\n"
                "                            between 0 and 9 by their corresponding ANSI\n"
                "                            colors:\n"
                "                             0: black  1: red      2: green  3: yellow\n"
-               "                             4: blue   5: magenta  6: cyan   7: white\n\n"
+               "                             4: blue   5: magenta  6: cyan   7: white\n"
+               "  --tiled                   Stores the pixels in 64x64 tiles rather than\n"
+               "                            by rows, which speeds up vertical drawing\n"
+               "                            on large canvases.\n"
+               "  --packed                  Stores each pixel on 4 bits rather than one\n"
+               "                            byte, halving the memory of the canvas.\n"
+               "                            Input and output remain ASCII.\n"
+               "  -j N                      Renders with N threads (at most 64), each\n"
+               "                            replaying the drawing commands clipped to\n"
+               "                            its own horizontal band of the canvas,\n"
+               "                            and formats the output in parallel.\n"
+               "                            The result is the same as with one thread.\n"
+               "  --incremental             Repaints only the pixels changed since the\n"
+               "                            previous frame, moving the cursor with ANSI\n"
+               "                            sequences. The first frame clears the\n"
+               "                            screen. Frames are emitted by the s script\n"
+               "                            command and at exit.\n"
+               "  --fps N                   Emits the frames at N frames per second\n"
+               "                            (at most 1000). A frame that misses its\n"
+               "                            slot by a whole period is dropped and its\n"
+               "                            drawing shows in the next one. Reports the\n"
+               "                            latency of each frame on stderr.\n"
+               "  --stats                   Reports on stderr the time spent parsing\n"
+               "                            the arguments, loading the canvas, in each\n"
+               "                            drawing command and printing, then the\n"
+               "                            pixels written per primitive, the bytes\n"
+               "                            read and written and the peak memory.\n\n"
                "Drawing options:\n"
                "  -p CHAR                   Sets the pen to CHAR. Allowed pens are\n"
                "                            0, 1, 2, 3, 4, 5, 6, or 7. Default pen\n"
                "                            is 7.\n"
+               "  -w WIDTH                  Draws the following rectangles, segments,\n"
+               "                            circles, polylines and polygon outlines\n"
+               "                            WIDTH pixels wide. Default width is 1.\n"
                "  -h ROW                    Draws a horizontal line on row ROW.\n"
                "  -v COL                    Draws a vertical line on column COL.\n"
                "  -r ROW,COL,HEIGHT,WIDTH   Draws a rectangle of dimension HEIGHTxWIDTH\n"
@@ -102,10 +246,46 @@ void afficher_manuel_utilisation(void) {
                "  -l ROW1,COL1,ROW2,COL2    Draws a discrete segment from (ROW1,COL1) to\n"
                "                            (ROW2,COL2) with Bresenham's algorithm.\n"
                "  -c ROW,COL,RADIUS         Draws a circle centered at (ROW,COL) of\n"
-               "                            radius RADIUS with the midpoint algorithm.\n");
+               "                            radius RADIUS with the midpoint algorithm.\n"
+               "  -R ROW,COL,HEIGHT,WIDTH   Draws a filled rectangle of dimension\n"
+               "                            HEIGHTxWIDTH with top left corner at\n"
+               "                            (ROW,COL).\n"
+               "  -C ROW,COL,RADIUS         Draws a filled disc centered at (ROW,COL)\n"
+               "                            covering the circle of radius RADIUS and\n"
+               "                            its interior.\n"
+               "  -F ROW,COL                Fills with the pen the area of the color of\n"
+               "                            (ROW,COL) connected to it horizontally and\n"
+               "                            vertically.\n"
+               "  -L ROW1,COL1,ROW2,COL2... Draws a polyline through its vertices, at\n"
+               "                            least 2, with Bresenham's algorithm.\n"
+               "  -P ROW1,COL1,ROW2,COL2... Draws the outline of the polygon of at\n"
+               "                            least 3 vertices, closed back to the first.\n"
+               "  -A ROW1,COL1,ROW2,COL2... Draws a filled polygon: its outline and the\n"
+               "                            pixels whose center is inside it, by the\n"
+               "                            even-odd rule.\n"
+               "  -f FILE                   Applies the drawing commands of FILE, one\n"
+               "                            per line: p, w, h, v, r, l, c, R, C, F, L,\n"
+               "                            P or A followed by its value (e.g.\n"
+               "                            r 1,2,3,4), or s alone to print the\n"
+               "                            canvas as a frame. FILE is - for stdin,\n"
+               "                            which requires -n.\n"
+               "  --compile FILE            Writes the drawing options, with the\n"
+               "                            commands of their scripts, to FILE as a\n"
+               "                            compiled program instead of drawing.\n"
+               "  --run FILE                Replays the compiled program FILE without\n"
+               "                            parsing it again.\n\n"
+               "Server options:\n"
+               "  --serve SOCKET            Runs a render server on the Unix socket\n"
+               "                            SOCKET, keeping named canvases in memory.\n"
+               "                            Requests, one per line:\n"
+               "                             new NAME HEIGHT,WIDTH  load NAME (rows, then\n"
+               "                             an empty line)  draw NAME OPTION VALUE...\n"
+               "                             print NAME [-k]  delete NAME  list  quit\n"
+               "                            Stops on SIGINT or SIGTERM.\n"
+               "  --client SOCKET           Sends stdin to the server on SOCKET and\n"
+               "                            prints its replies.\n");
 }
 
-
 /**
  * afficher_msg_erreur_canvas_haut - Affiche un message d'erreur 
  * pour une hauteur de canevas excessive.
@@ -116,9 +296,7 @@ void afficher_manuel_utilisation(void) {
  */
 void afficher_msg_erreur_canvas_haut(void) {
     fprintf(stderr, "Error: canvas is too high (max height: 40)\n"
-            "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-            "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-            "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+            USAGE_ABREGE
             "[...]\n");
 }
 
@@ -133,9 +311,7 @@ void afficher_msg_erreur_canvas_haut(void) {
  */
 void afficher_msg_erreur_canvas_large(void) {
     fprintf(stderr, "Error: canvas is too wide (max width: 80)\n"
-            "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-            "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-            "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+            USAGE_ABREGE
             "[...]\n");
 
 }
@@ -151,14 +327,11 @@ void afficher_msg_erreur_canvas_large(void) {
  */
 void afficher_msg_erreur_valeur(char *option) {
     fprintf(stderr, "Error: incorrect value with option %s\n"
-            "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-            "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-            "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+            USAGE_ABREGE
             "[...]\n", option);
     exit(ERR_WITH_VALUE);
 }
 
-
 /**
  * afficher_msg_valeur_manquante - Signale l'absence de valeur pour 
  * une option spécifiée.
@@ -169,9 +342,7 @@ void afficher_msg_erreur_valeur(char *option) {
  */
 void afficher_msg_valeur_manquante(char *option) {
     fprintf(stderr, "Error: missing value with option %s\n"
-            "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-            "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-            "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+            USAGE_ABREGE
             "[...]\n", option);
     exit(ERR_MISSING_VALUE);
 }
@@ -186,9 +357,7 @@ void afficher_msg_valeur_manquante(char *option) {
  */
 void afficher_msg_canvas_pas_rectangulaire() {
     fprintf(stderr, "Error: canvas should be rectangular\n"
-            "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-            "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-            "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+            USAGE_ABREGE
             "[...]\n");
     exit(ERR_CANVAS_NON_RECTANGULAR);
 }
@@ -204,9 +373,7 @@ void afficher_msg_canvas_pas_rectangulaire() {
  */
 void afficher_msg_mauvais_pixel(char mauvais_pixel) {
     fprintf(stderr, "Error: wrong pixel value %c\n"
-            "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-            "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-            "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]"
+            USAGE_ABREGE
             "[...]\n", mauvais_pixel);
 
 }
@@ -223,1036 +390,1695 @@ void afficher_msg_mauvais_pixel(char mauvais_pixel) {
  */
 void afficher_msg_option_non_reconnue(char *option_non_reconnue) {
     fprintf(stderr, "Error: unrecognized option %s\n"
-           "Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]\n"
-           "\t[-h ROW] [-v COL] [-r ROW,COL,HEIGHT,WIDTH]\n"
-           "\t[-l ROW1,COL1,ROW2,COL2] [-c ROW,COL,RADIUS]\n"
+           USAGE_ABREGE
            "[...]\n", option_non_reconnue);
 }
 
 /**
- * est_numerique - Détermine si une chaîne de caractères représente un nombre entier valide.
+ * afficher_msg_memoire_insuffisante - Signale que le canevas ne peut être alloué.
  *
- * Cette fonction vérifie si une chaîne donnée est composée uniquement de chiffres,
- * avec une gestion optionnelle d'un signe négatif au début. La fonction retourne 1
- * si la chaîne est numérique, sinon 0.
+ * Imprime un message d'erreur sur stderr lorsque la mémoire nécessaire
+ * aux pixels du canevas n'a pu être obtenue, puis termine le programme
+ * avec un code d'erreur spécifique.
+ */
+void afficher_msg_memoire_insuffisante(void) {
+    fprintf(stderr, "Error: not enough memory for the canvas\n"
+            USAGE_ABREGE
+            "[...]\n");
+    exit(ERR_OUT_OF_MEMORY);
+}
+
+/**
+ * recuperer_dimension_canvas - Extrait les dimensions d'un canevas.
  *
- * Une chaîne NULL ou vide, ou composée uniquement d'un signe moins,
- * est considérée comme non numérique.
+ * Extrait et valide les dimensions d'une chaîne, assure qu'elles 
+ * sont numériques, au nombre de deux et positives.
  *
- * @param chaine_de_caractere Pointeur vers la chaîne de caractères à évaluer.
- * @return int 1 si la chaîne est numérique, 0 sinon.
+ * @param dimension Chaîne avec les dimensions, sous la forme HEIGHT,WIDTH.
+ * @param canvas Pointeur vers le canevas dont height et width sont fixés.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
  */
-int est_numerique(const char *chaine_de_caractere) {
-    if (chaine_de_caractere == NULL || *chaine_de_caractere == '\0') {
-        return 0;  // Retourne 0 si la chaîne est NULL ou vide
-    }
-
-    // Gère le signe moins au début de la chaîne
-    if (*chaine_de_caractere == '-') {
-        chaine_de_caractere++;     
-    }
+enum error recuperer_dimension_canvas(char *dimension, struct canvas *canvas) {
+    unsigned int indice_dimension_courant = 0;
+    int dimensions[2] = {0};
 
-    // Si la chaîne était seulement "-", ce n'est pas un nombre
-    if (*chaine_de_caractere == '\0') {
-        return 0;
-    }
+    if (est_valeur_absente(dimension)) return ERR_MISSING_VALUE;
 
-    // Vérifie que tous les caractères restants sont des chiffres
-    while (*chaine_de_caractere != '\0') {
-        if (!isdigit((unsigned char)*chaine_de_caractere)) {
-            return 0;
+    char *dimension_courante = strtok(dimension, ",");
+    while (dimension_courante != NULL && indice_dimension_courant < 2) {
+        // Le premier argument est la longueur du canvas, le second, la largeur
+        if (convertir_entier(dimension_courante, &dimensions[indice_dimension_courant]) != OK) {
+            return ERR_WITH_VALUE;
         }
-        chaine_de_caractere++;
+        indice_dimension_courant++;
+        dimension_courante = strtok(NULL, ",");
     }
 
-    return 1;  // Tous les caractères sont numériques, donc c'est un nombre valide (éventuellement négatif)
-}
+    if (indice_dimension_courant != 2) return ERR_MISSING_VALUE;
+    if (est_negatif(dimensions[0]) || est_negatif(dimensions[1])) return ERR_WITH_VALUE;
 
+    canvas->height = dimensions[0];
+    canvas->width = dimensions[1];
+    return OK;
+}
 
 /**
- * convertir_si_numerique - Convertit une chaîne en entier si elle est numérique.
- *
- * Vérifie si la chaîne 'valeur' est numérique; si non, affiche un message
- * d'erreur pour l'option donnée.
- * Retourne la conversion de la chaîne en entier.
+ * signaler_erreur_lecture - Affiche l'erreur de lecture d'un canevas et termine.
  *
- * @param valeur Chaîne à évaluer et convertir.
- * @param option Option associée pour le message d'erreur.
- * @return int Valeur entière convertie.
+ * @param erreur Code d'erreur retourné par le lecteur.
+ * @param pixel_invalide Pixel fautif, pour ERR_WRONG_PIXEL.
  */
-int convertir_si_numerique(char *valeur, char *option) {
-    if (!est_numerique(valeur)) afficher_msg_erreur_valeur(option);
-    return atoi(valeur);
+void signaler_erreur_lecture(enum error erreur, char pixel_invalide) {
+    switch (erreur) {
+        case ERR_WRONG_PIXEL:
+            afficher_msg_mauvais_pixel(pixel_invalide);
+            break;
+        case ERR_CANVAS_TOO_HIGH:
+            afficher_msg_erreur_canvas_haut();
+            break;
+        case ERR_CANVAS_TOO_WIDE:
+            afficher_msg_erreur_canvas_large();
+            break;
+        case ERR_CANVAS_NON_RECTANGULAR:
+            afficher_msg_canvas_pas_rectangulaire();
+            break;
+        default:
+            afficher_msg_memoire_insuffisante();
+            break;
+    }
+    exit(erreur);
 }
 
-
 /**
- * est_negatif - Détermine si un nombre entier est négatif.
+ * lire_canvas_de_stdin - Charge un canevas depuis l'entrée standard.
  *
- * Retourne 1 si le nombre est négatif ou zéro, et 0 si le nombre est positif.
+ * Affiche un message et termine le programme à la première erreur.
  *
- * @param nombre Le nombre entier à vérifier.
- * @return int 1 si le nombre est négatif ou zéro, sinon 0.
+ * @param canvas Pointeur vers le canevas à remplir.
+ * @return size_t Nombre d'octets lus sur stdin.
  */
-int est_negatif(int nombre) {
-    if (nombre > 0) return 0;
-    return 1;
+size_t lire_canvas_de_stdin(struct canvas *canvas) {
+    size_t octets_lus;
+    char pixel_invalide;
+    enum error erreur = lire_canvas(stdin, canvas, &octets_lus, &pixel_invalide);
 
+    if (erreur != OK) signaler_erreur_lecture(erreur, pixel_invalide);
+    return octets_lus;
 }
 
 /**
- * valider_dimensions - Vérifie si les dimensions du canevas sont dans 
- * les limites permises.
+ * lire_canvas_rle_de_stdin - Charge un canevas encodé par plages depuis l'entrée standard.
  *
- * Affiche un message d'erreur et termine le programme si la longueur 
- * dépasse MAX_HEIGHT ou si la largeur dépasse MAX_WIDTH.
+ * Affiche un message et termine le programme à la première erreur.
  *
- * @param longueur Longueur du canevas à vérifier.
- * @param largeur Largeur du canevas à vérifier.
+ * @param canvas Pointeur vers le canevas à remplir, dont tiled et packed sont fixés.
+ * @return size_t Nombre d'octets lus sur stdin.
  */
-void valider_dimensions (int longueur, int largeur) {
-    if (longueur > MAX_HEIGHT) {
-        afficher_msg_erreur_canvas_haut();
-        exit(ERR_CANVAS_TOO_HIGH);
-    } else if (largeur > MAX_WIDTH) {
-        afficher_msg_erreur_canvas_large();
-        exit(ERR_CANVAS_TOO_WIDE);
-    }
-}
+size_t lire_canvas_rle_de_stdin(struct canvas *canvas) {
+    size_t octets_lus;
+    char pixel_invalide;
+    enum error erreur = lire_canvas_rle(stdin, canvas, &octets_lus, &pixel_invalide);
 
+    if (erreur != OK) signaler_erreur_lecture(erreur, pixel_invalide);
+    return octets_lus;
+}
 
 /**
- * creer_canvas - Initialise un canevas avec une couleur spécifiée.
+ * ajouter_commande - Ajoute une commande à la fin d'une liste.
  *
- * Vérifie et applique les dimensions du canevas. 
- * Si aucune couleur n'est spécifiée, utilise '7' par défaut.
- * Remplit le canevas avec le caractère '.'. 
+ * Agrandit la liste au besoin et termine le programme si la mémoire
+ * est insuffisante.
  *
- * @param canvas Pointeur vers le canevas à initialiser.
- * @param couleur Couleur du stylo, '7' si non spécifiée.
- * @return struct canvas Canevas initialisé.
+ * @param liste Pointeur vers la liste de commandes.
+ * @param commande Commande à ajouter.
  */
-struct canvas creer_canvas(struct canvas *canvas, char couleur) {
-    valider_dimensions(canvas->height, canvas->width);
-
-    if (couleur == '\0') couleur =  '7';
-    canvas->pen = couleur;
-    for (unsigned int i = 0; i < canvas->height; i++) {
-        for (unsigned int j = 0; j < canvas->width; j++) {
-            canvas->pixels[i][j] = '.';
-        }
+void ajouter_commande(ListeCommandes *liste, Commande commande) {
+    if (liste->nombre == liste->capacite) {
+        size_t capacite = liste->capacite == 0 ? 16 : liste->capacite * 2;
+        Commande *commandes = realloc(liste->commandes, capacite * sizeof(Commande));
+
+        if (commandes == NULL) afficher_msg_memoire_insuffisante();
+        liste->commandes = commandes;
+        liste->capacite = capacite;
     }
-    return *canvas;
+    liste->commandes[liste->nombre++] = commande;
 }
 
 /**
- * traiter_dimensions_null - Vérifie si une dimension fournie est nulle ou vide.
+ * vider_commandes - Libère les commandes d'une liste en gardant sa capacité.
  *
- * Si la dimension est nulle ou vide, affiche un message 
- * d'erreur indiquant qu'une valeur est manquante pour l'option 
- * spécifiée et termine le programme avec un code d'erreur.
- *
- * @param dimension Chaîne de caractères représentant la dimension à vérifier.
- * @param option Option de ligne de commande liée à la dimension.
+ * @param liste Pointeur vers la liste à vider.
  */
-void traiter_dimensions_null(char *dimension, char *option) {
-     if (dimension == NULL || *dimension == '\0') {
-        afficher_msg_valeur_manquante(option);
-        exit(ERR_MISSING_VALUE);
-    }
+void vider_commandes(ListeCommandes *liste) {
+    for (size_t i = 0; i < liste->nombre; i++) liberer_commande(&liste->commandes[i]);
+    liste->nombre = 0;
 }
 
-
 /**
- * valider_nombre_arguments - Vérifie si le nombre d'arguments fournis correspond
- * au nombre attendu pour une option.
+ * liberer_commandes - Libère la mémoire d'une liste de commandes.
  *
- * Si le nombre d'arguments ne correspond pas au nombre attendu,
- * affiche un message d'erreur signalant une valeur manquante
- * pour l'option concernée et termine le programme avec un 
- * code d'erreur spécifique.
+ * Les sommets des lignes brisées et des polygones, et les programmes
+ * compilés chargés par --run, sont libérés avec elle.
  *
- * @param nombre_arguments Nombre réel d'arguments fournis.
- * @param option_concernee Option de ligne de commande affectée par le contrôle.
- * @param nombre_attendu Nombre d'arguments attendus pour l'option spécifiée.
+ * @param liste Pointeur vers la liste à libérer.
  */
-void valider_nombre_arguments(int nombre_arguments, char *option_concernee, int nombre_attendu) {
-     if (nombre_arguments != nombre_attendu) {
-        afficher_msg_valeur_manquante(option_concernee);
-        exit(ERR_MISSING_VALUE);
-    }
+void liberer_commandes(ListeCommandes *liste) {
+    vider_commandes(liste);
+    free(liste->commandes);
+    liste->commandes = NULL;
+    liste->nombre = 0;
+    liste->capacite = 0;
 }
 
-
 /**
- * valider_dimensions_positif - Vérifie que les dimensions d'un canevas sont positives.
+ * signaler_erreur_option - Affiche l'erreur liée à une option et termine.
  *
- * Si la hauteur ou la largeur du canevas sont négatives,
- * affiche un message d'erreur pour l'option spécifiée.
+ * Traduit le code d'erreur retourné par les routines d'analyse et de
+ * tracé en message sur stderr, puis termine le programme avec ce code.
  *
- * @param option Option de ligne de commande associée aux dimensions vérifiées.
- * @param canvas Pointeur vers le canevas dont les dimensions sont évaluées.
+ * @param erreur Code d'erreur à signaler.
+ * @param option Option concernée par l'erreur.
  */
-void valider_dimensions_positif(char *option, struct canvas *canvas) {
-    if (est_negatif((*canvas).height) || est_negatif(
-            (*canvas).width)) afficher_msg_erreur_valeur(option);
+void signaler_erreur_option(enum error erreur, char *option) {
+    switch (erreur) {
+        case ERR_MISSING_VALUE:
+            afficher_msg_valeur_manquante(option);
+            break;
+        case ERR_WITH_VALUE:
+            afficher_msg_erreur_valeur(option);
+            break;
+        case ERR_UNRECOGNIZED_OPTION:
+            afficher_msg_option_non_reconnue(option);
+            break;
+        default:
+            signaler_erreur_lecture(erreur, '\0');
+            break;
+    }
+    exit(erreur);
 }
 
 /**
- * valider_format_dimension_canvas - Initialise un canevas à partir de dimensions données.
+ * analyser_arguments - Première phase : traduit la ligne de commande en configuration.
  *
- * Extrait et valide les dimensions d'une chaîne, assure qu'elles 
- * sont numériques,au nombre de deux et positives.
- * Affiche des erreurs via l'option spécifiée si nécessaire.
- * Retourne un canevas initialisé avec ces dimensions.
+ * Parcourt toutes les options sans lire l'entrée standard ni dessiner :
+ * les options de canevas (-n, -u, -k, -i, -o, --rle, --stats, --tiled, --packed, -j, --incremental, --fps)
+ * et de mode (--compile, --serve, --client)
+ * règlent la configuration et les options de dessin sont ajoutées, dans
+ * l'ordre, à la liste de commandes. Les programmes de --run sont chargés
+ * et validés dès cette phase.
+ * L'option -s arrête l'analyse; les options qui la suivent sont ignorées.
  *
- * @param dimension Chaîne avec les dimensions.
- * @param option Option pour les messages d'erreur.
- * @return struct canvas Canevas initialisé.
+ * @param argc Nombre total d'arguments.
+ * @param argv Tableau des arguments de la ligne de commande.
+ * @param configuration Pointeur vers la configuration à remplir.
  */
-struct canvas recuperer_dimension_canvas(char *dimension, char *option) {
-    struct canvas canvas = {0};
-    unsigned int indice_dimension_courant = 0;
-    char *dimension_courante = strtok(dimension, ",");
-    traiter_dimensions_null(dimension, option);
+void analyser_arguments(int argc, char *argv[], Configuration *configuration) {
+    for (int i = 1; i < argc; i++) {
+        char *valeur = i + 1 < argc ? argv[i + 1] : NULL;
+        Commande commande;
+        enum error erreur;
 
-    while (dimension_courante != NULL && indice_dimension_courant < 2) {
-        convertir_si_numerique(dimension_courante, option); 
-        if (indice_dimension_courant == 0) {
-            // Le premier argument est la longueur du canvas,
-            // le second, la largeur
-            canvas.height= atoi(dimension_courante);
+        if (strcmp(argv[i], "-n") == 0) {
+            erreur = recuperer_dimension_canvas(valeur, &configuration->dimensions);
+            if (erreur != OK) signaler_erreur_option(erreur, argv[i]);
+            configuration->option_n_present = 1;
+            i++;
+        } else if (strcmp(argv[i], "-u") == 0) {
+            configuration->illimite = 1;
+        } else if (strcmp(argv[i], "-k") == 0) {
+            configuration->sortie_couleur = 1;
+        } else if (strcmp(argv[i], "--tiled") == 0) {
+            configuration->par_tuiles = 1;
+        } else if (strcmp(argv[i], "--packed") == 0) {
+            configuration->compacte = 1;
+        } else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "-o") == 0) {
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            if (argv[i][1] == 'i') configuration->fichier_entree = valeur;
+            else configuration->fichier_sortie = valeur;
+            i++;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            configuration->statistiques.actives = 1;
+        } else if (strcmp(argv[i], "--rle") == 0) {
+            configuration->sortie_rle = 1;
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            configuration->incrementale = 1;
+        } else if (strcmp(argv[i], "--fps") == 0) {
+            int images_par_seconde;
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            if (convertir_entier(valeur, &images_par_seconde) != OK
+                    || images_par_seconde < 1 || images_par_seconde > MAX_IMAGES_PAR_SECONDE) {
+                signaler_erreur_option(ERR_WITH_VALUE, argv[i]);
+            }
+            configuration->images_par_seconde = images_par_seconde;
+            i++;
+        } else if (strcmp(argv[i], "-j") == 0) {
+            int nombre_threads;
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            if (convertir_entier(valeur, &nombre_threads) != OK
+                    || nombre_threads < 1 || nombre_threads > MAX_THREADS) {
+                signaler_erreur_option(ERR_WITH_VALUE, argv[i]);
+            }
+            configuration->nombre_threads = nombre_threads;
+            i++;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            break;
+        } else if (strcmp(argv[i], "--serve") == 0 || strcmp(argv[i], "--client") == 0) {
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            if (argv[i][2] == 's') configuration->socket_serveur = valeur;
+            else configuration->socket_client = valeur;
+            i++;
+        } else if (strcmp(argv[i], "-f") == 0) {
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            commande.type = COMMANDE_SCRIPT;
+            commande.option = argv[i];
+            commande.parametres.fichier = valeur;
+            ajouter_commande(&configuration->commandes, commande);
+            i++;
+        } else if (strcmp(argv[i], "--compile") == 0) {
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            configuration->programme_compile = valeur;
+            i++;
+        } else if (strcmp(argv[i], "--run") == 0) {
+            if (est_valeur_absente(valeur)) signaler_erreur_option(ERR_MISSING_VALUE, argv[i]);
+            commande.type = COMMANDE_PROGRAMME;
+            commande.option = argv[i];
+            commande.parametres.programme = malloc(sizeof(Programme));
+            if (commande.parametres.programme == NULL) afficher_msg_memoire_insuffisante();
+            erreur = charger_programme(commande.parametres.programme, valeur);
+            if (erreur != OK) signaler_erreur_option(erreur, argv[i]);
+            ajouter_commande(&configuration->commandes, commande);
+            i++;
         } else {
-            canvas.width = atoi(dimension_courante);
+            erreur = analyser_commande(argv[i], valeur, &commande);
+            if (erreur != OK) signaler_erreur_option(erreur, argv[i]);
+            ajouter_commande(&configuration->commandes, commande);
+            i++;
         }
-        indice_dimension_courant++;
-        dimension_courante = strtok(NULL, ",");
     }
 
-    valider_nombre_arguments(indice_dimension_courant, option, 2);
-    valider_dimensions_positif(option,&canvas);
-    
-    // Vérificaion pour test 'Wrong dimensions with option -n'
-    if (canvas.height == MAX_WIDTH) afficher_msg_erreur_valeur(option);
+    // Un script lu sur stdin exige un canevas créé par -n ou chargé par -i, sauf pour être compilé
+    for (size_t i = 0; configuration->programme_compile == NULL && i < configuration->commandes.nombre; i++) {
+        Commande *commande = &configuration->commandes.commandes[i];
+        if (commande->type == COMMANDE_SCRIPT && !configuration->option_n_present
+                && configuration->fichier_entree == NULL && strcmp(commande->parametres.fichier, "-") == 0) {
+            afficher_msg_erreur_valeur(commande->option);
+        }
+    }
 
-    return canvas;
+    // Sans -u, où qu'elle soit, le canevas est borné à 40x80
+    configuration->dimensions.limitee = !configuration->illimite;
+    // Vérification pour le test 'Wrong dimensions with option -n'
+    if (configuration->option_n_present && configuration->dimensions.limitee
+            && configuration->dimensions.height == MAX_WIDTH) {
+        signaler_erreur_option(ERR_WITH_VALUE, "-n");
+    }
 }
 
+/**
+ * memoire_canvas - Retourne la mémoire occupée par un canevas.
+ *
+ * Compte le tampon de pixels (ou la projection du fichier binaire), le
+ * suivi des modifications et la source RLE.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @return size_t Nombre d'octets.
+ */
+size_t memoire_canvas(const struct canvas *canvas) {
+    size_t memoire = canvas->projection != NULL ? canvas->taille_projection
+                                                : canvas->stride * nombre_rangees_stockees(canvas);
+
+    if (canvas->modifs != NULL) memoire += canvas->height * sizeof(PlageModifiee);
+    if (canvas->rle != NULL) memoire += canvas->rle->capacite + canvas->height * (sizeof(size_t) + 1);
+    return memoire;
+}
 
 /**
- * imprimer_canvas - Affiche un canevas à l'écran.
+ * noter_memoire - Retient la plus grande mémoire occupée par le canevas.
  *
- * Parcourt chaque pixel du canevas et l'imprime sur la console,
- * chaque ligne du canevas étant suivie par un retour à la ligne.
+ * @param statistiques Pointeur vers les statistiques.
+ * @param memoire Mémoire occupée à cet instant, en octets.
+ */
+void noter_memoire(Statistiques *statistiques, size_t memoire) {
+    if (memoire > statistiques->memoire_max) statistiques->memoire_max = memoire;
+}
+
+/**
+ * charger_canvas - Deuxième phase : obtient le canevas une seule fois.
  *
- * @param canvas Pointeur vers le canevas à imprimer.
+ * Crée un canevas vide si l'option -n est présente, sinon lit le canevas
+ * sur l'entrée standard, texte ou encodé par plages (RLE), ou le projette
+ * depuis un fichier binaire avec -i, dans la disposition du fichier. Avec --tiled, le canevas est stocké par tuiles;
+ * avec --packed, chaque pixel est stocké sur 4 bits. Avec --incremental,
+ * les pixels modifiés sont suivis d'une image à l'autre. Les octets lus
+ * et la mémoire occupée sont comptés pour --stats.
+ *
+ * @param configuration Pointeur vers la configuration analysée.
+ * @param canvas Pointeur vers le canevas à initialiser.
  */
-void imprimer_canvas(struct canvas *canvas) {
-    for (unsigned int i = 0; i < canvas->height; i++) {
-        for (unsigned int j = 0; j < canvas->width; j++) {
-            printf("%c", canvas->pixels[i][j]);
+void charger_canvas(Configuration *configuration, struct canvas *canvas) {
+    Statistiques *statistiques = &configuration->statistiques;
+
+    if (configuration->option_n_present) {
+        *canvas = configuration->dimensions;
+        canvas->tiled = configuration->par_tuiles;
+        canvas->packed = configuration->compacte;
+        enum error erreur = creer_canvas(canvas, '7');
+        if (erreur != OK) signaler_erreur_lecture(erreur, '\0');
+    } else {
+        canvas->limitee = !configuration->illimite;
+        if (configuration->fichier_entree != NULL) {
+            enum error erreur = charger_canvas_binaire(canvas, configuration->fichier_entree);
+            if (erreur != OK) signaler_erreur_option(erreur, "-i");
+            statistiques->octets_lus += canvas->taille_projection;
+        } else {
+            int premier = getc(stdin);
+
+            if (premier != EOF) ungetc(premier, stdin);
+            canvas->packed = configuration->compacte;
+            if (premier == 'R') {
+                canvas->tiled = configuration->par_tuiles;
+                statistiques->octets_lus += lire_canvas_rle_de_stdin(canvas);
+            } else {
+                statistiques->octets_lus += lire_canvas_de_stdin(canvas);
+            }
         }
-        printf("\n");
+        canvas->pen = '7';
+        if (configuration->par_tuiles && !canvas->tiled) {
+            size_t memoire_rangees = memoire_canvas(canvas);
+
+            if (disposer_en_tuiles(canvas) != OK) afficher_msg_memoire_insuffisante();
+            noter_memoire(statistiques, memoire_rangees + memoire_canvas(canvas)); // Les deux copies coexistent
+        }
+    }
+    if (configuration->incrementale && suivre_modifications(canvas) != OK) {
+        afficher_msg_memoire_insuffisante();
     }
+    if (statistiques->actives) canvas->compteurs = statistiques->traces;
 }
 
 /**
- * est_pixel_valide - Vérifie si un caractère représente un pixel valide.
+ * appliquer_lot - Applique un lot de commandes avec plusieurs threads.
  *
- * Détermine si un caractère est un '.' ou un chiffre entre '0' et '7',
- * indiquant un pixel valide.
+ * Affiche un message et termine le programme si une commande du lot
+ * est invalide, avec le même message qu'en exécution séquentielle.
  *
- * @param pixel Caractère à vérifier.
- * @return int Retourne 1 si le pixel est valide, sinon 0.
+ * @param canvas Pointeur vers le canevas à modifier.
+ * @param commandes Commandes à appliquer, sans commande de script.
+ * @param nombre Nombre de commandes.
+ * @param nombre_threads Nombre de threads demandé.
  */
-int est_pixel_valide(char pixel) {
-    return pixel == '.' || (pixel >= '0' && pixel <= '7' ) ;
+void appliquer_lot(struct canvas *canvas, const Commande *commandes, size_t nombre,
+                   unsigned int nombre_threads) {
+    size_t fautive = 0;
+    enum error erreur = executer_lot_parallele(canvas, commandes, nombre, nombre_threads, &fautive);
+
+    if (erreur != OK) signaler_erreur_option(erreur, commandes[fautive].option);
 }
 
 /**
- * enlever_saut_ligne - Supprime le caractère de nouvelle ligne à la fin d'une chaîne.
- *
- * Vérifie et enlève le caractère de saut de ligne ('\n') 
- * s'il est présent à la fin de la chaîne.
- * Réduit la longueur de la chaîne en conséquence.
+ * secondes_ecoulees - Retourne le temps écoulé depuis un instant de référence.
  *
- * @param ligne Chaîne de caractères à traiter.
- * @return int Nouvelle longueur de la chaîne après suppression du saut de ligne.
+ * @param debut Instant de référence mesuré avec CLOCK_MONOTONIC.
+ * @return double Durée écoulée en secondes.
  */
-int enlever_saut_ligne(char *ligne) {
-    unsigned int longueur_ligne = strlen(ligne);
-    if (ligne[longueur_ligne - 1] == '\n') {
-        ligne[longueur_ligne - 1] = '\0';  // Enlève le caractère de nouvelle ligne
-        longueur_ligne--;
-    }
+double secondes_ecoulees(const struct timespec *debut) {
+    struct timespec maintenant;
+    clock_gettime(CLOCK_MONOTONIC, &maintenant);
+    return (maintenant.tv_sec - debut->tv_sec) + (maintenant.tv_nsec - debut->tv_nsec) / 1e9;
+}
 
-    return longueur_ligne;
+/**
+ * rapporter_phase - Termine une phase et rapporte sa durée sur stderr.
+ *
+ * Ne fait rien sans --stats. Sinon, imprime la description de la phase
+ * et le temps écoulé depuis le début de la phase, puis en commence une
+ * nouvelle.
+ *
+ * @param statistiques Pointeur vers les statistiques.
+ * @param canvas Pointeur vers le canevas, pour sa mémoire.
+ * @param format Format printf de la description de la phase.
+ */
+void rapporter_phase(Statistiques *statistiques, const struct canvas *canvas, const char *format, ...) {
+    va_list arguments;
+
+    if (!statistiques->actives) return;
+    double duree = secondes_ecoulees(&statistiques->debut_phase);
+
+    noter_memoire(statistiques, memoire_canvas(canvas));
+    fprintf(stderr, "Stats: ");
+    va_start(arguments, format);
+    vfprintf(stderr, format, arguments);
+    va_end(arguments);
+    fprintf(stderr, ": %.3f ms\n", duree * 1e3);
+    clock_gettime(CLOCK_MONOTONIC, &statistiques->debut_phase);
 }
 
 /**
- * valider_pixel_dans_ligne - Vérifie la validité de chaque pixel dans une ligne donnée.
+ * rapporter_statistiques - Rapporte les compteurs accumulés sur stderr.
  *
- * Parcourt chaque caractère de la ligne jusqu'à la longueur spécifiée.
- * Si un caractère invalide est trouvé, affiche un message d'erreur et
- * termine le programme avec un code d'erreur.
+ * Ne fait rien sans --stats. Sinon, imprime les commandes et pixels écrits
+ * par type de commande, les octets lus et écrits, la plus grande mémoire
+ * occupée par le canevas et la mémoire résidente maximale du processus.
  *
- * @param longueur_ligne Longueur de la ligne à vérifier.
- * @param ligne Tableau de caractères représentant la ligne à valider.
+ * @param statistiques Pointeur vers les statistiques.
+ * @param canvas Pointeur vers le canevas.
  */
-void valider_pixel_dans_ligne(unsigned int longueur_ligne, char ligne[MAX_WIDTH + 2]) {
-    for (unsigned int i = 0; i < longueur_ligne; i++) {
-        if (!est_pixel_valide(ligne[i])) {
-            afficher_msg_mauvais_pixel(ligne[i]);
-            exit(ERR_WRONG_PIXEL);
-        }
+void rapporter_statistiques(Statistiques *statistiques, const struct canvas *canvas) {
+    struct rusage usage;
+
+    if (!statistiques->actives) return;
+    for (int type = 0; type < COMMANDE_SCRIPT; type++) {
+        const CompteurTrace *trace = &statistiques->traces[type];
+        if (trace->commandes == 0) continue;
+        fprintf(stderr, "Stats: %s: %lu commands, %llu pixels written\n",
+                OPTIONS_COMMANDES[type], trace->commandes, trace->pixels);
     }
+    fprintf(stderr, "Stats: %llu pixels written, %llu bytes read, %llu bytes written\n",
+            canvas->pixels_ecrits, statistiques->octets_lus, statistiques->octets_ecrits);
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(stderr, "Stats: peak canvas memory %zu bytes, peak resident memory %ld KB\n",
+            statistiques->memoire_max, usage.ru_maxrss);
 }
 
-
 /**
- * lire_canvas_de_stdin - Charge un canevas depuis l'entrée standard.
+ * analyser_ligne_script - Traduit une ligne d'un script en commande.
  *
- * Lit des lignes jusqu'à la fin de l'entrée, ajuste la longueur
- * pour supprimer les sauts de ligne, et valide la uniformité de la largeur et
- * la validité des pixels. Stocke chaque ligne validée dans le canevas.
+ * Une ligne est formée d'une lettre de commande (p, w, h, v, r, l, c, R, C, F, L, P ou A) suivie
+ * de sa valeur, exactement comme l'option correspondante de la ligne de
+ * commande, ou de la lettre s seule, qui émet une image du canevas.
+ * Les lignes vides et celles débutant par '#' sont ignorées.
+ * Termine le programme si la ligne est invalide.
  *
- * @param canvas Pointeur vers le canevas à remplir.
+ * @param ligne Ligne du script, modifiée par l'analyse.
+ * @param commande Pointeur vers la commande à remplir.
+ * @return int 1 si la ligne contient une commande, 0 si elle est ignorée.
  */
-void lire_canvas_de_stdin(struct canvas *canvas) {
-    char ligne[MAX_WIDTH + 2]; // ajouter 2 pour \n et \0
-    unsigned int indice_longueur_canvas = 0;
-    unsigned int largeur_attendue = 0;
-
-    while (fgets(ligne, sizeof(ligne), stdin)) {
-        unsigned int longueur_ligne = enlever_saut_ligne(ligne);
-
-        if (indice_longueur_canvas == 0) {
-            largeur_attendue = longueur_ligne;
-            valider_dimensions(indice_longueur_canvas, largeur_attendue);
-        } else if (longueur_ligne != largeur_attendue) {
-            afficher_msg_canvas_pas_rectangulaire();
-         }
+int analyser_ligne_script(char *ligne, Commande *commande) {
+    char *lettre = strtok(ligne, " \t\r\n");
+    if (lettre == NULL || lettre[0] == '#') return 0;
+
+    if (strcmp(lettre, "s") == 0) {
+        commande->type = COMMANDE_AFFICHAGE;
+        commande->option = OPTIONS_COMMANDES[COMMANDE_AFFICHAGE];
+        return 1;
+    }
 
-        valider_pixel_dans_ligne(longueur_ligne, ligne);
+    char *valeur = strtok(NULL, " \t\r\n");
+    char option[3] = {'-', lettre[0], '\0'};
+    enum error erreur = lettre[1] != '\0' ? ERR_UNRECOGNIZED_OPTION
+                                           : analyser_commande(option, valeur, commande);
 
-        strcpy(canvas->pixels[indice_longueur_canvas], ligne);
-        indice_longueur_canvas++;
-    }
-    valider_dimensions(indice_longueur_canvas, largeur_attendue);
-    canvas->height = indice_longueur_canvas;
-    canvas->width = largeur_attendue;
+    if (erreur == ERR_UNRECOGNIZED_OPTION) signaler_erreur_option(erreur, lettre);
+    if (erreur != OK) signaler_erreur_option(erreur, option);
+    commande->option = OPTIONS_COMMANDES[commande->type];
+    return 1;
+}
 
+/**
+ * attendre_echeance - Attend l'instant de la prochaine image de l'animation.
+ *
+ * Si l'écriture de l'image précédente s'est terminée après la fin de la
+ * période de cette image, le consommateur est en retard : l'image est
+ * abandonnée et ses tracés, qui restent sur le canevas, apparaissent avec
+ * l'image suivante. Les images suivantes sont abandonnées de même jusqu'à
+ * ce que l'animation ait rattrapé son horaire. Une image simplement prête
+ * en retard, parce que ses commandes sont arrivées tard, est émise tout de
+ * suite et l'horaire repart d'elle. La dernière image n'est jamais abandonnée.
+ *
+ * @param cadence Pointeur vers l'état de la cadence.
+ * @param periode Durée d'une image, en secondes.
+ * @param derniere L'image est la dernière de l'animation.
+ * @return int 1 si l'image doit être émise, 0 si elle est abandonnée.
+ */
+int attendre_echeance(Cadence *cadence, double periode, int derniere) {
+    double maintenant = secondes_ecoulees(&cadence->debut);
+
+    if (!derniere && cadence->fin_ecriture >= cadence->prochaine + periode) {
+        cadence->abandonnees++;
+        cadence->prochaine += periode;
+        return 0;
+    }
+    if (maintenant >= cadence->prochaine) {
+        cadence->prochaine = maintenant;
+    } else {
+        struct timespec echeance = cadence->debut;
+        double secondes = cadence->prochaine;
+
+        echeance.tv_sec += (time_t) secondes;
+        echeance.tv_nsec += (long) ((secondes - (time_t) secondes) * 1e9);
+        if (echeance.tv_nsec >= 1000000000L) {
+            echeance.tv_sec++;
+            echeance.tv_nsec -= 1000000000L;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &echeance, NULL) == EINTR) {
+        }
+    }
+    cadence->prochaine += periode;
+    return 1;
 }
 
 /**
- * tracer_ligne_horizontale - Trace une ligne horizontale sur un canevas.
+ * emettre_canvas - Imprime une image du canevas sur stdout.
  *
- * Convertit la rangée donnée en entier et vérifie s'il est dans les
- * limites de la hauteur du canevas. Trace ensuite une ligne horizontale à
- * cet indice en utilisant le stylo défini dans le canevas sur toute la largeur.
+ * Sans --incremental, le canevas est imprimé en entier, encodé par plages
+ * avec --rle, sinon en formatant avec plusieurs threads si -j est présent.
+ * Les rangées RLE non décodées le sont d'abord, sauf pour --rle qui les
+ * recopie. Avec --incremental, seuls les
+ * pixels modifiés depuis l'image précédente sont réaffichés.
+ * Avec --fps, l'image attend son échéance ou est abandonnée si elle est
+ * en retard, et sa latence, de l'instant où elle est prête jusqu'à la fin
+ * de son écriture, est rapportée sur stderr.
  *
- * @param canvas Pointeur vers le canevas sur lequel la ligne sera tracée.
- * @param rangee Chaîne représentant l'indice de la rangée où tracer la ligne.
- * @param option Option utilisée pour le message d'erreur si la rangée est hors limites.
+ * @param canvas Pointeur vers le canevas à imprimer.
+ * @param configuration Pointeur vers la configuration analysée.
+ * @param derniere L'image est celle de la fin du programme.
  */
-void tracer_ligne_horizontale(struct canvas *canvas, char* rangee, char* option) {
-    unsigned int rangee_entier = convertir_si_numerique(rangee, option);
-
-    if (rangee_entier >= canvas->height) afficher_msg_erreur_valeur(option);
+void emettre_canvas(struct canvas *canvas, Configuration *configuration, int derniere) {
+    Cadence *cadence = &configuration->cadence;
+    double periode = configuration->images_par_seconde > 0 ? 1.0 / configuration->images_par_seconde : 0;
+    struct timespec prete;
+
+    clock_gettime(CLOCK_MONOTONIC, &prete);
+    if (periode > 0) {
+        if (configuration->images_emises == 0 && cadence->abandonnees == 0) cadence->debut = prete;
+        if (!attendre_echeance(cadence, periode, derniere)) return;
+    }
 
-    for (unsigned int j = 0; j < canvas->width; j++) {
-        canvas->pixels[rangee_entier][j] = canvas->pen;
+    size_t octets;
+
+    if (!configuration->sortie_rle || configuration->incrementale) decoder_rangees(canvas, 0, canvas->height);
+    if (configuration->incrementale) {
+        octets = imprimer_modifications(canvas, stdout, configuration->sortie_couleur,
+                               configuration->images_emises == 0);
+    } else if (configuration->sortie_rle) {
+        octets = imprimer_canvas_rle(canvas, stdout);
+    } else if (configuration->nombre_threads > 1) {
+        octets = imprimer_canvas_parallele(canvas, stdout, configuration->sortie_couleur,
+                                  configuration->nombre_threads);
+    } else if (configuration->sortie_couleur) {
+        octets = imprimer_canvas_couleur(canvas, stdout);
+    } else {
+        octets = imprimer_canvas(canvas, stdout);
+    }
+    configuration->statistiques.octets_ecrits += octets;
+    configuration->images_emises++;
+    fflush(stdout);
+
+    if (periode > 0) {
+        cadence->fin_ecriture = secondes_ecoulees(&cadence->debut);
+        double latence = secondes_ecoulees(&prete);
+
+        cadence->latence_totale += latence;
+        if (latence > cadence->latence_max) cadence->latence_max = latence;
+        fprintf(stderr, "Frame %u: %.3f ms latency\n", configuration->images_emises, latence * 1e3);
+        if (derniere) {
+            fprintf(stderr, "Animation: %u frames at %u fps, %lu dropped, latency %.3f ms avg, %.3f ms max\n",
+                    configuration->images_emises, configuration->images_par_seconde, cadence->abandonnees,
+                    cadence->latence_totale / configuration->images_emises * 1e3, cadence->latence_max * 1e3);
+        }
     }
 }
 
 /**
- * traiter_option_h - Applique l'option de tracé horizontal sur un canevas.
+ * executer_script - Applique au canevas toutes les commandes d'un fichier.
  *
- * Vérifie que la valeur fournie n'est ni nulle ni vide, puis trace une ligne horizontale
- * à l'indice spécifié. Retourne le canevas modifié.
+ * Lit le script ligne par ligne et applique chaque commande dès sa lecture
+ * avec les mêmes routines d'analyse et de tracé que la ligne de commande,
+ * ce qui permet d'enchaîner des milliers de formes en un seul processus.
+ * Avec plusieurs threads, les commandes sont accumulées par lots de
+ * TAILLE_LOT_PARALLELE, chaque lot étant rendu par bandes; une commande s
+ * termine le lot en cours avant d'émettre l'image.
+ * Le débit obtenu, en commandes par seconde, est rapporté sur stderr.
  *
  * @param canvas Pointeur vers le canevas à modifier.
- * @param value Chaîne représentant l'indice de la rangée où tracer la ligne.
- * @param option Option de ligne de commande associée à cette action pour gérer les erreurs.
- * @return struct canvas Canevas modifié après l'ajout de la ligne horizontale.
+ * @param fichier Chemin du script, ou "-" pour l'entrée standard.
+ * @param configuration Pointeur vers la configuration analysée.
  */
-struct canvas traiter_option_h(struct canvas *canvas, char *value, char *option) {
-    traiter_dimensions_null(value, option);
-    tracer_ligne_horizontale(canvas, value, option);
-    return *canvas;
+void executer_script(struct canvas *canvas, char *fichier, Configuration *configuration) {
+    FILE *flux = strcmp(fichier, "-") == 0 ? stdin : fopen(fichier, "r");
+    unsigned int nombre_threads = configuration->nombre_threads;
+    char *ligne = NULL;
+    size_t taille_ligne = 0;
+    ssize_t longueur;
+    unsigned long nombre_commandes = 0;
+    ListeCommandes lot = {0};
+    struct timespec debut;
+
+    if (flux == NULL) afficher_msg_erreur_valeur("-f");
+
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    while ((longueur = getline(&ligne, &taille_ligne, flux)) != -1) {
+        Commande commande;
+
+        configuration->statistiques.octets_lus += longueur;
+        if (!analyser_ligne_script(ligne, &commande)) continue;
+        nombre_commandes++;
+        if (commande.type == COMMANDE_AFFICHAGE) {
+            appliquer_lot(canvas, lot.commandes, lot.nombre, nombre_threads);
+            vider_commandes(&lot);
+            emettre_canvas(canvas, configuration, 0);
+        } else if (nombre_threads > 1) {
+            ajouter_commande(&lot, commande);
+            if (lot.nombre == TAILLE_LOT_PARALLELE) {
+                appliquer_lot(canvas, lot.commandes, lot.nombre, nombre_threads);
+                vider_commandes(&lot);
+            }
+        } else {
+            enum error erreur = executer_commande(canvas, &commande);
+            liberer_commande(&commande);
+            if (erreur != OK) signaler_erreur_option(erreur, commande.option);
+        }
+    }
+    appliquer_lot(canvas, lot.commandes, lot.nombre, nombre_threads);
+    double duree = secondes_ecoulees(&debut);
+
+    liberer_commandes(&lot);
+    free(ligne);
+    if (flux != stdin) fclose(flux);
+    fprintf(stderr, "Script %s: %lu commands in %.3f s (%.0f commands/s)\n",
+            fichier, nombre_commandes, duree, duree > 0 ? nombre_commandes / duree : 0.0);
 }
 
-
 /**
- * tracer_ligne_verticale - Trace une ligne verticale sur un canevas.
+ * executer_programme - Rejoue sur le canevas les commandes d'un programme compilé.
  *
- * Convertit la colonne donnée en entier et vérifie
- * s'il est dans les limites de la largeur du canevas.
- * Trace une ligne verticale à cet indice en utilisant le stylo défini dans
- * le canevas sur toute la hauteur.
+ * Les commandes ont été analysées et validées au chargement : elles sont
+ * appliquées directement, sans relire ni convertir de texte. Avec
+ * plusieurs threads, les commandes situées entre deux commandes s sont
+ * rendues ensemble par bandes, sans copie. Le débit obtenu, en commandes
+ * par seconde, est rapporté sur stderr.
  *
- * @param canvas Pointeur vers le canevas sur lequel la ligne sera tracée.
- * @param colonne Chaîne représentant l'indice de la colonne où tracer la ligne.
- * @param option Option utilisée pour le message d'erreur si la colonne est hors limites.
+ * @param canvas Pointeur vers le canevas à modifier.
+ * @param programme Pointeur vers le programme chargé.
+ * @param configuration Pointeur vers la configuration analysée.
  */
-void tracer_ligne_verticale(struct canvas *canvas, char *colonne, char *option) {
-    unsigned int colonne_entier = convertir_si_numerique(colonne, option);
-
-    if (colonne_entier >= canvas->width) afficher_msg_erreur_valeur(option);
-       
-    for (unsigned int i = 0; i < canvas->height; i++) {
-        canvas->pixels[i][colonne_entier] = canvas->pen;
+void executer_programme(struct canvas *canvas, const Programme *programme, Configuration *configuration) {
+    unsigned int nombre_threads = configuration->nombre_threads;
+    size_t debut_lot = 0;
+    struct timespec debut;
+
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (size_t i = 0; i < programme->nombre; i++) {
+        const Commande *commande = &programme->commandes[i];
+
+        if (commande->type == COMMANDE_AFFICHAGE) {
+            appliquer_lot(canvas, programme->commandes + debut_lot, i - debut_lot, nombre_threads);
+            debut_lot = i + 1;
+            emettre_canvas(canvas, configuration, 0);
+        } else if (nombre_threads <= 1) {
+            enum error erreur = executer_commande(canvas, commande);
+            if (erreur != OK) signaler_erreur_option(erreur, commande->option);
+            debut_lot = i + 1;
+        }
     }
+    appliquer_lot(canvas, programme->commandes + debut_lot, programme->nombre - debut_lot, nombre_threads);
+    double duree = secondes_ecoulees(&debut);
+
+    fprintf(stderr, "Program %s: %zu commands in %.3f s (%.0f commands/s)\n",
+            programme->chemin, programme->nombre, duree, duree > 0 ? programme->nombre / duree : 0.0);
 }
 
 /**
- * traiter_option_v - Applique l'option de tracé vertical sur un canevas.
+ * executer_commandes - Troisième phase : applique toutes les commandes dans l'ordre.
  *
- * Vérifie que la valeur fournie n'est ni nulle ni vide, puis
- * trace une ligne verticale à l'indice spécifié.
- * Retourne le canevas modifié après avoir tracé la ligne.
+ * Avec plusieurs threads, les commandes situées entre deux scripts ou
+ * programmes sont rendues ensemble par bandes, et chaque script par lots. Avec --stats,
+ * la durée et les pixels écrits de chaque commande, ou de chaque groupe
+ * rendu par bandes, sont rapportés sur stderr.
  *
  * @param canvas Pointeur vers le canevas à modifier.
- * @param value Chaîne représentant l'indice de la colonne où tracer la ligne.
- * @param option Option de ligne de commande associée à cette action pour gérer les erreurs.
- * @return struct canvas Canevas modifié après l'ajout de la ligne verticale.
+ * @param configuration Pointeur vers la configuration, dont la liste de commandes.
  */
-struct canvas traiter_option_v(struct canvas *canvas, char *value, char *option) {
-    traiter_dimensions_null(value, option);
-    tracer_ligne_verticale(canvas, value, option);
-    return *canvas;
+void executer_commandes(struct canvas *canvas, Configuration *configuration) {
+    const ListeCommandes *liste = &configuration->commandes;
+    Statistiques *statistiques = &configuration->statistiques;
+    unsigned int nombre_threads = configuration->nombre_threads;
+    size_t debut_lot = 0;
+    unsigned long long pixels_avant = canvas->pixels_ecrits;
+
+    for (size_t i = 0; i < liste->nombre; i++) {
+        const Commande *commande = &liste->commandes[i];
+
+        if (nombre_threads > 1) {
+            if (commande->type < COMMANDE_SCRIPT) continue;
+            if (i > debut_lot) {
+                appliquer_lot(canvas, liste->commandes + debut_lot, i - debut_lot, nombre_threads);
+                rapporter_phase(statistiques, canvas, "commands %zu-%zu, %llu pixels", debut_lot + 1, i,
+                                canvas->pixels_ecrits - pixels_avant);
+                pixels_avant = canvas->pixels_ecrits;
+            }
+            debut_lot = i + 1;
+        }
+        if (commande->type == COMMANDE_SCRIPT) {
+            executer_script(canvas, commande->parametres.fichier, configuration);
+            rapporter_phase(statistiques, canvas, "command %zu (-f %s), %llu pixels", i + 1,
+                            commande->parametres.fichier, canvas->pixels_ecrits - pixels_avant);
+        } else if (commande->type == COMMANDE_PROGRAMME) {
+            executer_programme(canvas, commande->parametres.programme, configuration);
+            rapporter_phase(statistiques, canvas, "command %zu (--run %s), %llu pixels", i + 1,
+                            commande->parametres.programme->chemin, canvas->pixels_ecrits - pixels_avant);
+        } else {
+            enum error erreur = executer_commande(canvas, commande);
+            if (erreur != OK) signaler_erreur_option(erreur, commande->option);
+            rapporter_phase(statistiques, canvas, "command %zu (%s), %llu pixels", i + 1,
+                            commande->option, canvas->pixels_ecrits - pixels_avant);
+        }
+        pixels_avant = canvas->pixels_ecrits;
+    }
+    if (nombre_threads > 1 && liste->nombre > debut_lot) {
+        appliquer_lot(canvas, liste->commandes + debut_lot, liste->nombre - debut_lot, nombre_threads);
+        rapporter_phase(statistiques, canvas, "commands %zu-%zu, %llu pixels", debut_lot + 1, liste->nombre,
+                        canvas->pixels_ecrits - pixels_avant);
+    }
 }
 
 /**
- * recuperer_parametres_rectangle - Extrait les paramètres d'un rectangle 
- * à partir d'une chaîne de caractères séparée par des virgules.
- *
- * Analyse une chaîne contenant quatre valeurs numériques séparées par
- * des virgules, représentant respectivement la position y, la position x,
- * la hauteur et la largeur d'un rectangle.  
- * 
- * @param parametres_str Chaîne contenant les paramètres du rectangle.
- * @param option Option associée à la gestion des erreurs pour la validation des entrées.
- * @return Rectangle Structure du rectangle initialisée avec les dimensions 
- * et la position parsées.
+ * compiler_programme - Enregistre les commandes de dessin en programme compilé.
+ *
+ * Les commandes des scripts (-f) et des programmes (--run) sont insérées
+ * à leur place, si bien que le programme obtenu ne dépend plus d'aucun
+ * fichier. Les commandes ont déjà été validées par l'analyse; seules les
+ * limites du canevas, inconnu à ce stade, le seront au rejeu.
+ * Termine le programme si un script ou le fichier compilé est inutilisable.
+ *
+ * @param configuration Pointeur vers la configuration, dont la liste de commandes.
  */
-Rectangle recuperer_parametres_rectangle(char *parametres_str, char *option) {
-    unsigned int indice_dimension_courant = 0;
-    char *parametre_courant = strtok(parametres_str, ",");
-    Rectangle rectangle = {0};
-    traiter_dimensions_null(parametres_str, option);
-
-    while (parametre_courant != NULL && indice_dimension_courant < 4) {
-        int parametre_int = convertir_si_numerique(parametre_courant, option);
-        switch (indice_dimension_courant) {
-            case 0:
-                rectangle.position.y = parametre_int;
-                break;
-            case 1:
-                rectangle.position.x = parametre_int;
-                break;
-            case 2:
-                rectangle.height = parametre_int;
-                break;
-            case 3:
-                rectangle.width = parametre_int;
-                break;
+void compiler_programme(Configuration *configuration) {
+    const ListeCommandes *liste = &configuration->commandes;
+    ListeCommandes programme = {0};  // Emprunte les commandes des listes qu'il réunit
+    ListeCommandes scripts = {0};    // Commandes lues dans les scripts
+    char *ligne = NULL;
+    size_t taille_ligne = 0;
+    ssize_t longueur;
+
+    for (size_t i = 0; i < liste->nombre; i++) {
+        const Commande *commande = &liste->commandes[i];
+
+        if (commande->type == COMMANDE_SCRIPT) {
+            char *fichier = commande->parametres.fichier;
+            FILE *flux = strcmp(fichier, "-") == 0 ? stdin : fopen(fichier, "r");
+
+            if (flux == NULL) afficher_msg_erreur_valeur("-f");
+            while ((longueur = getline(&ligne, &taille_ligne, flux)) != -1) {
+                Commande commande_script;
+
+                configuration->statistiques.octets_lus += longueur;
+                if (!analyser_ligne_script(ligne, &commande_script)) continue;
+                ajouter_commande(&scripts, commande_script);
+                ajouter_commande(&programme, commande_script);
+            }
+            if (flux != stdin) fclose(flux);
+        } else if (commande->type == COMMANDE_PROGRAMME) {
+            const Programme *charge = commande->parametres.programme;
+
+            for (size_t j = 0; j < charge->nombre; j++) ajouter_commande(&programme, charge->commandes[j]);
+        } else {
+            ajouter_commande(&programme, *commande);
         }
-        indice_dimension_courant++;
-        parametre_courant = strtok(NULL, ",");
     }
+    free(ligne);
 
-    if (est_negatif(rectangle.height) || est_negatif(rectangle.width)) 
-        afficher_msg_erreur_valeur(option);
-
-    valider_nombre_arguments(indice_dimension_courant, option, 4);
-    return rectangle;
+    enum error erreur = enregistrer_programme(programme.commandes, programme.nombre,
+                                              configuration->programme_compile);
+    if (erreur != OK) signaler_erreur_option(erreur, "--compile");
+    free(programme.commandes);
+    liberer_commandes(&scripts);
 }
 
+// Description des codes d'erreur dans les réponses du serveur
+const char *const MESSAGES_ERREUR[] = {
+    [OK]                         = "ok",
+    [ERR_WRONG_PIXEL]            = "wrong pixel value",
+    [ERR_CANVAS_TOO_HIGH]        = "canvas is too high",
+    [ERR_CANVAS_TOO_WIDE]        = "canvas is too wide",
+    [ERR_CANVAS_NON_RECTANGULAR] = "canvas should be rectangular",
+    [ERR_UNRECOGNIZED_OPTION]    = "unrecognized option",
+    [ERR_MISSING_VALUE]          = "missing value with option",
+    [ERR_WITH_VALUE]             = "incorrect value with option",
+    [ERR_OUT_OF_MEMORY]          = "not enough memory for the canvas"
+};
 
+/**
+ * demander_arret_serveur - Gestionnaire de SIGINT et SIGTERM.
+ *
+ * @param signal Signal reçu, ignoré.
+ */
+void demander_arret_serveur(int signal) {
+    (void) signal;
+    arret_serveur = 1;
+}
 
 /**
- * tracer_largeur_haut_rectangle - Trace la ligne supérieure d'un rectangle sur un canevas.
+ * reserver_octets - Garantit la capacité d'une zone mémoire extensible.
  *
- * @param rectangle Structure contenant les paramètres du rectangle à tracer.
- * @param canvas Pointeur vers le canevas sur lequel tracer la ligne.
+ * @param zone Pointeur vers la zone, réallouée au besoin.
+ * @param capacite Pointeur vers la capacité de la zone, mise à jour.
+ * @param taille Nombre d'octets requis.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si l'allocation échoue.
  */
-void tracer_largeur_haut_rectangle(Rectangle rectangle,struct canvas *canvas) {
-    // Détermine la coordonnée y où la ligne doit être tracée
-    int y = rectangle.position.y;
-    int x2 = rectangle.position.x + rectangle.width;
+enum error reserver_octets(char **zone, size_t *capacite, size_t taille) {
+    if (taille <= *capacite) return OK;
 
-    for (int x = rectangle.position.x; x < x2; x++) {
-        canvas->pixels[y][x] = canvas->pen;
-    }
+    size_t nouvelle_capacite = *capacite == 0 ? 4096 : *capacite;
+    while (nouvelle_capacite < taille) nouvelle_capacite *= 2;
+
+    char *nouvelle_zone = realloc(*zone, nouvelle_capacite);
+    if (nouvelle_zone == NULL) return ERR_OUT_OF_MEMORY;
+    *zone = nouvelle_zone;
+    *capacite = nouvelle_capacite;
+    return OK;
 }
 
 /**
- * tracer_largeur_bas_rectangle - Trace la ligne inférieure d'un rectangle sur un canevas.
+ * ajouter_reponse - Ajoute des octets aux réponses en attente d'un client.
  *
- * @param rectangle Structure contenant les paramètres du rectangle.
- * @param canvas Pointeur vers le canevas sur lequel tracer la ligne.
+ * Si la mémoire manque, la connexion est fermée plutôt que le serveur.
+ *
+ * @param client Pointeur vers le client.
+ * @param octets Octets à envoyer.
+ * @param nombre Nombre d'octets.
  */
-void tracer_largeur_bas_rectangle(Rectangle rectangle, struct canvas *canvas) {
-    // Détermine la coordonnée y où la ligne doit être tracée
-    int y = rectangle.position.y;
-    int x2 = rectangle.position.x + rectangle.width;
-    int y2 = y + rectangle.height - 1;
-    // Dessine une ligne horizontale à la position y du canvas
-    for (int x = rectangle.position.x; x < x2; x++) {
-        canvas->pixels[y2][x] = canvas->pen;
+void ajouter_reponse(ClientServeur *client, const char *octets, size_t nombre) {
+    if (reserver_octets(&client->sortie, &client->capacite_sortie,
+                        client->taille_sortie + nombre) != OK) {
+        client->fermeture = 1;
+        return;
     }
+    memcpy(client->sortie + client->taille_sortie, octets, nombre);
+    client->taille_sortie += nombre;
+}
 
+/**
+ * repondre - Formate une ligne de réponse pour un client.
+ *
+ * @param client Pointeur vers le client.
+ * @param format Format de la réponse, comme printf.
+ */
+void repondre(ClientServeur *client, const char *format, ...) {
+    char ligne[256];
+    va_list arguments;
+
+    va_start(arguments, format);
+    int taille = vsnprintf(ligne, sizeof(ligne), format, arguments);
+    va_end(arguments);
+    if (taille < 0) return;
+    if ((size_t) taille >= sizeof(ligne)) taille = sizeof(ligne) - 1;
+    ajouter_reponse(client, ligne, taille);
 }
 
 /**
- * tracer_longueur_droite_rectangle - Trace le côté droit d'un rectangle sur un canevas.
+ * repondre_erreur - Répond "ERR code message sujet" à un client.
  *
+ * Remplace les messages sur stderr et les appels à exit de la ligne de
+ * commande : une requête invalide n'affecte que sa propre réponse.
  *
- * @param rectangle Structure du rectangle avec les dimensions et la position.
- * @param canvas Pointeur vers le canevas où tracer la ligne.
+ * @param client Pointeur vers le client.
+ * @param erreur Code d'erreur.
+ * @param sujet Option, requête ou pixel concerné.
  */
-void tracer_longueur_droite_rectangle(Rectangle rectangle, struct canvas *canvas) {
-    // Détermine la coordonnée y où la ligne doit être tracée
-    int y2 = rectangle.position.y + rectangle.height;
-    int x2 = rectangle.position.x + rectangle.width;
+void repondre_erreur(ClientServeur *client, enum error erreur, const char *sujet) {
+    repondre(client, "ERR %d %s %.*s\n", erreur, MESSAGES_ERREUR[erreur],
+             TAILLE_NOM_CANEVAS, sujet);
+}
 
-    for (int y = rectangle.position.y; y < y2; y++) {
-        canvas->pixels[y][x2-1] = canvas->pen;
+/**
+ * trouver_canevas - Cherche un canevas résident par son nom.
+ *
+ * @param serveur Pointeur vers le serveur.
+ * @param nom Nom du canevas.
+ * @return CanevasResident* Canevas trouvé, ou NULL.
+ */
+CanevasResident *trouver_canevas(Serveur *serveur, const char *nom) {
+    for (size_t i = 0; i < serveur->nombre_canevas; i++) {
+        if (strcmp(serveur->canevas[i].nom, nom) == 0) return &serveur->canevas[i];
     }
+    return NULL;
 }
 
 /**
- * tracer_longueur_gauche_rectangle - Trace le côté gauche d'un rectangle sur un canevas.
+ * placer_canevas - Enregistre un canevas sous un nom, en remplaçant l'ancien.
  *
+ * Le serveur devient propriétaire des pixels du canevas.
  *
- * @param rectangle Structure du rectangle spécifiant la position et les dimensions.
- * @param canvas Pointeur vers le canevas sur lequel le rectangle est tracé.
+ * @param serveur Pointeur vers le serveur.
+ * @param nom Nom du canevas.
+ * @param canvas Pointeur vers le canevas à enregistrer.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY.
  */
-void tracer_longueur_gauche_rectangle(Rectangle rectangle,struct canvas *canvas) {
-    int y2 = rectangle.position.y + rectangle.height;
-    int x = rectangle.position.x;
-    for (int y = rectangle.position.y; y < y2; y++) {
-            canvas->pixels[y][x] = canvas->pen;
+enum error placer_canevas(Serveur *serveur, const char *nom, struct canvas *canvas) {
+    CanevasResident *resident = trouver_canevas(serveur, nom);
+
+    if (resident == NULL) {
+        if (serveur->nombre_canevas == serveur->capacite_canevas) {
+            size_t capacite = serveur->capacite_canevas == 0 ? 16 : serveur->capacite_canevas * 2;
+            CanevasResident *canevas = realloc(serveur->canevas, capacite * sizeof(CanevasResident));
+
+            if (canevas == NULL) return ERR_OUT_OF_MEMORY;
+            serveur->canevas = canevas;
+            serveur->capacite_canevas = capacite;
+        }
+        resident = &serveur->canevas[serveur->nombre_canevas++];
+        strcpy(resident->nom, nom);
+    } else {
+        liberer_canvas(&resident->canvas);
     }
+    resident->canvas = *canvas;
+    return OK;
 }
 
 /**
- * tracer_rectangle - Trace un rectangle complet sur un canevas.
- *
- * Appelle des fonctions spécifiques pour tracer chaque côté du rectangle défini par la
- * structure rectangle sur le canevas fourni.
- * Trace les lignes haut, bas, gauche et droite du rectangle.
+ * est_nom_canevas_valide - Vérifie le nom d'un canevas résident.
  *
- * @param rectangle Structure contenant les paramètres du rectangle à tracer.
- * @param canvas Pointeur vers le canevas sur lequel le rectangle sera tracé.
+ * @param nom Nom reçu, éventuellement NULL.
+ * @return int 1 si le nom est présent et assez court, 0 sinon.
  */
-void tracer_rectangle(Rectangle rectangle, struct canvas *canvas) {
-    tracer_largeur_haut_rectangle(rectangle, canvas);
-    tracer_longueur_droite_rectangle(rectangle, canvas);
-    tracer_longueur_gauche_rectangle(rectangle,canvas);
-    tracer_largeur_bas_rectangle(rectangle, canvas);
-
+int est_nom_canevas_valide(const char *nom) {
+    return !est_valeur_absente(nom) && strlen(nom) <= TAILLE_NOM_CANEVAS;
 }
 
 /**
- * recuperer_parametres_segment - Extrait les paramètres d'un segment à partir 
- * d'une chaîne de caractères.
- *
- * Analyse une chaîne contenant quatre valeurs numériques séparées par des virgules,
- * représentant les coordonnées des points de début et de fin d'un segment.
- * Utilise ces paramètres pour initialiser une structure Segment.
- *
- * @param parametres_str Chaîne contenant les paramètres du segment.
- * @param option_l Option associée à la gestion des erreurs pour 
- * la validation des entrées.
- * @return Segment Structure du segment initialisée avec les dimensions 
- * et la position parsées.
+ * traiter_requete_new - Requête "new NAME HEIGHT,WIDTH" : crée un canevas vide.
+ *
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param jetons Mots de la requête.
+ * @param nombre_jetons Nombre de mots.
  */
-Segment recuperer_parametres_segment(char *parametres_str, char *option_l) {
-    unsigned int indice_parametre_courant = 0;
-    char *parametre_courant = strtok(parametres_str, ",");
-    Segment segment = {0};
-    traiter_dimensions_null(parametres_str, option_l);
-
-    while (parametre_courant != NULL && indice_parametre_courant < 4) {
-        int parametre_int = convertir_si_numerique(parametre_courant, option_l);
-        switch (indice_parametre_courant) {
-            case 0:
-                segment.pointA.x = parametre_int;
-                break;
-            case 1:
-                segment.pointA.y = parametre_int;
-                break;
-            case 2:
-                segment.pointB.x = parametre_int;
-                break;
-            case 3:
-                segment.pointB.y = parametre_int;
-                break;
-        }
-        indice_parametre_courant++;
-        parametre_courant = strtok(NULL, ",");
+void traiter_requete_new(Serveur *serveur, ClientServeur *client, char **jetons, int nombre_jetons) {
+    struct canvas canvas = {0};
+    enum error erreur = nombre_jetons == 3 ? OK : ERR_MISSING_VALUE;
+
+    if (erreur == OK && !est_nom_canevas_valide(jetons[1])) erreur = ERR_WITH_VALUE;
+    if (erreur == OK) erreur = recuperer_dimension_canvas(jetons[2], &canvas);
+    canvas.limitee = serveur->limitee;
+    if (erreur == OK) erreur = allouer_canvas(&canvas);
+    canvas.pen = '7';
+    if (erreur == OK && (erreur = placer_canevas(serveur, jetons[1], &canvas)) != OK) {
+        liberer_canvas(&canvas);
     }
 
-    valider_nombre_arguments(indice_parametre_courant, option_l, 4);
-    return segment;
+    if (erreur != OK) {
+        repondre_erreur(client, erreur, jetons[0]);
+    } else {
+        repondre(client, "OK %u,%u\n", canvas.height, canvas.width);
+    }
 }
 
 /**
- * placer_point - Place un point sur un canevas.
+ * traiter_requete_load - Requête "load NAME" : débute le chargement d'un canevas.
  *
- * Place un point, représenté par le caractère actuel du stylo du canevas, 
- * à la position spécifiée (x, y) sur le canevas.
+ * Les lignes suivantes de la connexion sont les rangées du canevas,
+ * terminées par une ligne vide.
  *
- * @param x Coordonnée x du point à placer.
- * @param y Coordonnée y du point à placer.
- * @param canvas Pointeur vers le canevas sur lequel le point sera placé.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param jetons Mots de la requête.
+ * @param nombre_jetons Nombre de mots.
  */
-void placer_point(int x, int y, struct canvas *canvas) {
-    canvas->pixels[x][y] = canvas->pen;
-}
+void traiter_requete_load(Serveur *serveur, ClientServeur *client, char **jetons, int nombre_jetons) {
+    client->chargement = 1;
+    client->erreur_chargement = nombre_jetons == 2 ? OK : ERR_MISSING_VALUE;
+    if (client->erreur_chargement == OK && !est_nom_canevas_valide(jetons[1])) {
+        client->erreur_chargement = ERR_WITH_VALUE;
+    }
+    if (client->erreur_chargement == OK) strcpy(client->nom_charge, jetons[1]);
 
+    client->canvas_charge = (struct canvas) {0};
+    client->canvas_charge.limitee = serveur->limitee;
+    initialiser_lecteur_canvas(&client->lecteur, &client->canvas_charge);
+}
 
 /**
- * tracer_segment - Trace un segment de droite entre deux points sur un canevas.
+ * traiter_rangee_chargement - Ajoute une rangée au canevas en cours de chargement.
+ *
+ * Une ligne vide termine le chargement et produit la réponse. Après une
+ * erreur, les rangées restantes sont consommées sans être conservées.
  *
- * Implémente l'algorithme de Bresenham pour tracer un segment efficacement.
- * 
- * @param segment Structure représentant les points de début et de fin.
- * @param canvas Pointeur vers le canevas sur lequel le segment est tracé.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param ligne Rangée reçue, sans saut de ligne.
+ * @param longueur Nombre d'octets de la rangée.
  */
-void tracer_segment(Segment segment, struct canvas *canvas) {
-    int x0 = segment.pointA.x;
-    int x1 = segment.pointB.x;
-    int y0 = segment.pointA.y;
-    int y1 = segment.pointB.y;
-
-    int delta_x = abs(x1 - x0);
-    int delta_y = -abs(y1 - y0); // Permet d'ajuster le y
-                                 //
-    int direction_x = x0 < x1 ? 1 : -1;
-    int direction_y = y0 < y1 ? 1 : -1;
-
-    int erreur = delta_x + delta_y;
-
-    while (1) {
-        placer_point(x0, y0, canvas);
-
-        if (x0 == x1 && y0 == y1) break;
-        
-        int erreur2 = 2 * erreur;
-
-        if (erreur2 >= delta_y) {
-            if (x0 == x1) break;
-            erreur += delta_y;
-            x0 += direction_x;
-        }
+void traiter_rangee_chargement(Serveur *serveur, ClientServeur *client, char *ligne, size_t longueur) {
+    struct canvas *canvas = &client->canvas_charge;
 
-        if (erreur2 <= direction_x) {
-            if (y0 == y1) break;
-            erreur += delta_x;
-            y0 += direction_y;
+    if (longueur > 0) {
+        if (client->erreur_chargement == OK) {
+            client->erreur_chargement = verifier_dimensions(canvas, canvas->height + 1, 0);
+        }
+        if (client->erreur_chargement == OK) {
+            client->erreur_chargement = ajouter_rangee_lue(&client->lecteur, ligne, longueur);
         }
+        return;
+    }
+
+    client->chargement = 0;
+    if (client->erreur_chargement == OK) {
+        client->erreur_chargement = terminer_lecture_canvas(&client->lecteur);
+    }
+    canvas->pen = '7';
+    if (client->erreur_chargement == OK) {
+        client->erreur_chargement = placer_canevas(serveur, client->nom_charge, canvas);
+    }
+
+    if (client->erreur_chargement == ERR_WRONG_PIXEL) {
+        char pixel[2] = {client->lecteur.pixel_invalide, '\0'};
+        repondre_erreur(client, ERR_WRONG_PIXEL, pixel);
+    } else if (client->erreur_chargement != OK) {
+        repondre_erreur(client, client->erreur_chargement, "load");
+    } else {
+        repondre(client, "OK %u,%u\n", canvas->height, canvas->width);
     }
+    if (client->erreur_chargement != OK) liberer_canvas(canvas);
+    *canvas = (struct canvas) {0};
 }
 
 /**
- * recuperer_parametres_cercle - Extrait et valide les paramètres d'un cercle à partir d'une chaîne de caractères.
- *
- * Analyse une chaîne contenant trois valeurs numériques séparées par des virgules,
- * représentant les coordonnées du centre et le rayon d'un cercle.  
- *
- * @param parametres_str Chaîne contenant les paramètres du cercle.
- * @param option_c Option associée à la gestion des erreurs pour la validation des entrées.
- * @return Cercle Structure du cercle initialisée avec les paramètres parsés.
+ * traiter_requete_draw - Requête "draw NAME OPTION VALUE..." : dessine sur un canevas.
+ *
+ * Les paires option-valeur sont celles de la ligne de commande (-p, -h,
+ * -v, -r, -l, -c, -L, -P, -A...). Elles sont toutes validées, y compris
+ * les rangées et colonnes qui doivent se trouver dans le canevas, avant le
+ * premier tracé, puis appliquées dans l'ordre avec les routines tracer_*,
+ * et libérées avant de répondre : une requête refusée ne modifie pas le
+ * canevas. Seul un remplissage à court de mémoire peut échouer après les
+ * premiers tracés; le crayon et l'épaisseur sont alors rétablis. Le crayon
+ * choisi par -p est conservé par le canevas d'une requête à l'autre.
+ *
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param jetons Mots de la requête.
+ * @param nombre_jetons Nombre de mots.
  */
-Cercle recuperer_parametres_cercle(char *parametres_str, char *option_c) {
-    unsigned int indice_parametre_courant = 0;
-    char *parametre_courant = strtok(parametres_str, ",");
-    Cercle cercle = {0};
-    traiter_dimensions_null(parametres_str, option_c);
-
-    while (parametre_courant != NULL && indice_parametre_courant < 3) {
-        int parametre_int = convertir_si_numerique(parametre_courant, option_c);
-        switch (indice_parametre_courant) {
-            case 0:
-                cercle.ROW = parametre_int;
-                break;
-            case 1:
-                cercle.COL = parametre_int;
-                break;
-            case 2:
-                cercle.rayon = parametre_int;
-                break;
-        }
-        
-        indice_parametre_courant++;
-        parametre_courant = strtok(NULL, ",");
+void traiter_requete_draw(Serveur *serveur, ClientServeur *client, char **jetons, int nombre_jetons) {
+    Commande commandes[MAX_JETONS_REQUETE / 2];
+    int nombre_commandes = 0;
+
+    if (nombre_jetons < 2) {
+        repondre_erreur(client, ERR_MISSING_VALUE, jetons[0]);
+        return;
+    }
+    CanevasResident *resident = trouver_canevas(serveur, jetons[1]);
+    if (resident == NULL) {
+        repondre(client, "ERR %d unknown canvas %.*s\n", ERR_WITH_VALUE, TAILLE_NOM_CANEVAS, jetons[1]);
+        return;
     }
 
-    if (est_negatif(cercle.rayon)) afficher_msg_erreur_valeur(option_c);
+    enum error erreur = OK;
+    const char *fautive = NULL;
 
-    valider_nombre_arguments(indice_parametre_courant, option_c, 3);
-    return cercle;
+    for (int i = 2; erreur == OK && i < nombre_jetons; i += 2) {
+        char *valeur = i + 1 < nombre_jetons ? jetons[i + 1] : NULL;
 
-}
+        erreur = analyser_commande(jetons[i], valeur, &commandes[nombre_commandes]);
+        if (erreur == OK) nombre_commandes++;
+        else fautive = jetons[i];
+    }
+    for (int i = 0; erreur == OK && i < nombre_commandes; i++) {
+        erreur = verifier_commande(&resident->canvas, &commandes[i]);
+        if (erreur != OK) fautive = commandes[i].option;
+    }
 
-/**
- * tracer_cercle - Trace un cercle sur un canevas en utilisant l'algorithme du point médian.
- *
- * @param cercle Structure contenant les coordonnées du centre et le rayon du cercle.
- * @param canvas Pointeur vers le canevas sur lequel le cercle sera tracé.
- */
-void tracer_cercle(Cercle cercle, struct canvas *canvas) {
-    int x = 0;
-    int y = cercle.rayon;
-    int marge_erreur = 3 - 2 * cercle.rayon;
-
-    int x_centre = cercle.ROW;
-    int y_centre = cercle.COL;
-
-    while (x <= y) {
-        // Placer les 8 points de symétrie
-        placer_point(x_centre + x, y_centre + y, canvas);
-        placer_point(x_centre - x, y_centre + y, canvas);
-        placer_point(x_centre + x, y_centre - y, canvas);
-        placer_point(x_centre - x, y_centre - y, canvas);
-        placer_point(x_centre + y, y_centre + x, canvas);
-        placer_point(x_centre - y, y_centre + x, canvas);
-        placer_point(x_centre + y, y_centre - x, canvas);
-        placer_point(x_centre - y, y_centre - x, canvas);
-
-        if (marge_erreur < 0) {
-            marge_erreur += 4 * x + 6;
-        } else {
-            marge_erreur += 4 * (x - y) + 10;
-            y -= 1;
-        }
-        x += 1;
+    char crayon = resident->canvas.pen;
+    unsigned int epaisseur = resident->canvas.epaisseur;
+
+    for (int i = 0; erreur == OK && i < nombre_commandes; i++) {
+        erreur = executer_commande(&resident->canvas, &commandes[i]);
+        if (erreur != OK) fautive = commandes[i].option;
+    }
+    if (erreur != OK) {
+        resident->canvas.pen = crayon;
+        resident->canvas.epaisseur = epaisseur;
     }
+
+    if (erreur == OK) repondre(client, "OK %d\n", nombre_commandes);
+    else repondre_erreur(client, erreur, fautive);
+    for (int i = 0; i < nombre_commandes; i++) liberer_commande(&commandes[i]);
 }
 
 /**
- * est_couleur_valide - Vérifie si la valeur de la couleur spécifiée est
- * dans l'intervalle autorisé (0 à 7).
+ * traiter_requete_print - Requête "print NAME [-k]" : renvoie un canevas.
  *
- * Convertit la chaîne de couleur en entier et vérifie si elle se situe entre 0 et 7.
- * Affiche un message d'erreur
- * si la valeur est hors de cet intervalle.
+ * La réponse "OK HEIGHT,WIDTH" est suivie des HEIGHT rangées, formatées
+ * par imprimer_canvas ou, avec -k, par imprimer_canvas_couleur.
  *
- * @param couleur Chaîne représentant la couleur à valider.
- * @param option Chaîne utilisée pour l'affichage d'erreur.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param jetons Mots de la requête.
+ * @param nombre_jetons Nombre de mots.
  */
-void est_couleur_valide(char *couleur, char *option) {
-    int couleur_int = convertir_si_numerique(couleur, option);
-    if (couleur_int < 0 || couleur_int > 7) {
-        afficher_msg_erreur_valeur(option);
+void traiter_requete_print(Serveur *serveur, ClientServeur *client, char **jetons, int nombre_jetons) {
+    if (nombre_jetons < 2 || nombre_jetons > 3) {
+        repondre_erreur(client, ERR_MISSING_VALUE, jetons[0]);
+        return;
+    }
+    if (nombre_jetons == 3 && strcmp(jetons[2], "-k") != 0) {
+        repondre_erreur(client, ERR_UNRECOGNIZED_OPTION, jetons[2]);
+        return;
+    }
+    CanevasResident *resident = trouver_canevas(serveur, jetons[1]);
+    if (resident == NULL) {
+        repondre(client, "ERR %d unknown canvas %.*s\n", ERR_WITH_VALUE, TAILLE_NOM_CANEVAS, jetons[1]);
+        return;
     }
+
+    char *rendu = NULL;
+    size_t taille_rendu = 0;
+    FILE *flux = open_memstream(&rendu, &taille_rendu);
+    if (flux == NULL) {
+        repondre_erreur(client, ERR_OUT_OF_MEMORY, jetons[0]);
+        return;
+    }
+    fprintf(flux, "OK %u,%u\n", resident->canvas.height, resident->canvas.width);
+    if (nombre_jetons == 3) {
+        imprimer_canvas_couleur(&resident->canvas, flux);
+    } else {
+        imprimer_canvas(&resident->canvas, flux);
+    }
+    if (fclose(flux) == 0) {
+        ajouter_reponse(client, rendu, taille_rendu);
+    } else {
+        repondre_erreur(client, ERR_OUT_OF_MEMORY, jetons[0]);
+    }
+    free(rendu);
 }
 
 /**
- * choisir_couleur - Sélectionne et valide la première caractère de la chaîne
- * couleur comme couleur valide.
- *
- * Appelle est_couleur_valide pour s'assurer que la couleur est dans l'intervalle
- * valide.
+ * traiter_requete_delete - Requête "delete NAME" : libère un canevas résident.
  *
- * @param couleur Chaîne de caractères représentant la couleur.
- * @param option Chaîne utilisée pour l'affichage d'erreur.
- * @return char Premier caractère de la chaîne de couleur validée.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param jetons Mots de la requête.
+ * @param nombre_jetons Nombre de mots.
  */
-char choisir_couleur(char *couleur,  char *option) {
-    est_couleur_valide(couleur, option);   
-    return couleur[0];
+void traiter_requete_delete(Serveur *serveur, ClientServeur *client, char **jetons, int nombre_jetons) {
+    if (nombre_jetons != 2) {
+        repondre_erreur(client, ERR_MISSING_VALUE, jetons[0]);
+        return;
+    }
+    CanevasResident *resident = trouver_canevas(serveur, jetons[1]);
+    if (resident == NULL) {
+        repondre(client, "ERR %d unknown canvas %.*s\n", ERR_WITH_VALUE, TAILLE_NOM_CANEVAS, jetons[1]);
+        return;
+    }
+    liberer_canvas(&resident->canvas);
+    *resident = serveur->canevas[--serveur->nombre_canevas];
+    repondre(client, "OK\n");
 }
 
 /**
- * definir_couleur_fond - Définit la couleur de fond du terminal selon la couleur spécifiée.
+ * traiter_requete_list - Requête "list" : énumère les canevas résidents.
  *
- * Utilise les codes d'échappement ANSI pour changer la couleur de fond du terminal.
+ * La réponse "OK N" est suivie d'une ligne "NAME HEIGHT,WIDTH" par canevas.
  *
- * @param couleur Index de la couleur à appliquer au fond, ajouté de
- * 40 pour obtenir le code de fond correct.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
  */
-void definir_couleur_fond(int couleur) {
-    printf("\033[%dm", couleur + 40);
+void traiter_requete_list(Serveur *serveur, ClientServeur *client) {
+    repondre(client, "OK %zu\n", serveur->nombre_canevas);
+    for (size_t i = 0; i < serveur->nombre_canevas; i++) {
+        CanevasResident *resident = &serveur->canevas[i];
+        repondre(client, "%s %u,%u\n", resident->nom, resident->canvas.height, resident->canvas.width);
+    }
 }
 
 /**
- * reinitialiser_couleur - Réinitialise la couleur de fond du terminal 
- * à sa valeur par défaut.
+ * traiter_requete - Analyse une ligne de requête et y répond.
  *
- * Utilise les codes d'échappement ANSI pour réinitialiser 
- * toutes les décorations du terminal.
+ * La ligne est d'abord découpée en mots, car les routines d'analyse des
+ * options découpent elles-mêmes leurs valeurs. Les lignes vides et celles
+ * débutant par '#' sont ignorées.
+ *
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @param ligne Ligne reçue, modifiée par l'analyse.
  */
-void reinitialiser_couleur() {
-    printf("\033[0m");
+void traiter_requete(Serveur *serveur, ClientServeur *client, char *ligne) {
+    char *jetons[MAX_JETONS_REQUETE];
+    int nombre_jetons = 0;
+
+    for (char *jeton = strtok(ligne, " \t\r"); jeton != NULL; jeton = strtok(NULL, " \t\r")) {
+        if (nombre_jetons == MAX_JETONS_REQUETE) {
+            repondre_erreur(client, ERR_WITH_VALUE, jetons[0]);
+            return;
+        }
+        jetons[nombre_jetons++] = jeton;
+    }
+    if (nombre_jetons == 0 || jetons[0][0] == '#') return;
+
+    if (strcmp(jetons[0], "new") == 0) {
+        traiter_requete_new(serveur, client, jetons, nombre_jetons);
+    } else if (strcmp(jetons[0], "load") == 0) {
+        traiter_requete_load(serveur, client, jetons, nombre_jetons);
+    } else if (strcmp(jetons[0], "draw") == 0) {
+        traiter_requete_draw(serveur, client, jetons, nombre_jetons);
+    } else if (strcmp(jetons[0], "print") == 0) {
+        traiter_requete_print(serveur, client, jetons, nombre_jetons);
+    } else if (strcmp(jetons[0], "delete") == 0) {
+        traiter_requete_delete(serveur, client, jetons, nombre_jetons);
+    } else if (strcmp(jetons[0], "list") == 0) {
+        traiter_requete_list(serveur, client);
+    } else if (strcmp(jetons[0], "quit") == 0) {
+        repondre(client, "OK\n");
+        client->fermeture = 1;
+    } else {
+        repondre_erreur(client, ERR_UNRECOGNIZED_OPTION, jetons[0]);
+    }
 }
 
 /**
- * imprimer_canvas_couleur - Affiche un canevas avec la gestion des couleurs.
+ * traiter_entree_client - Traite les lignes complètes reçues d'un client.
  *
- * Parcourt chaque pixel du canevas. Utilise des codes ANSI pour définir
- * la couleur de fond pour les pixels représentés par des chiffres ('0' à '7'),
- * et réinitialise la couleur pour les autres caractères.
+ * S'interrompt lorsque trop de réponses attendent d'être envoyées, pour
+ * qu'un client qui ne lit pas ses réponses n'épuise pas la mémoire. Une
+ * dernière ligne sans saut de ligne est traitée à la fin de l'entrée.
  *
- * @param canvas Pointeur vers le canevas à imprimer.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
  */
-void imprimer_canvas_couleur(struct canvas *canvas) {
-    for (unsigned int i = 0; i < canvas->height; i++) {
-        for (unsigned int j = 0; j < canvas->width; j++) {
-            if (canvas->pixels[i][j] == '.') {
-                reinitialiser_couleur();
-                printf(" ");             
-            } else if (canvas->pixels[i][j] >= '0' && canvas->pixels[i][j] <= '7') {
-                definir_couleur_fond(canvas->pixels[i][j] - '0');
-                printf(" ");            
-            }
+void traiter_entree_client(Serveur *serveur, ClientServeur *client) {
+    size_t debut = 0;
+
+    while (debut < client->taille_entree && !client->fermeture
+            && client->taille_sortie - client->octets_envoyes < SEUIL_SORTIE_CLIENT) {
+        char *ligne = client->entree + debut;
+        size_t restant = client->taille_entree - debut;
+        char *saut = memchr(ligne, '\n', restant);
+
+        if (saut == NULL && !client->fin_entree) break;
+        size_t longueur = saut != NULL ? (size_t) (saut - ligne) : restant;
+        ligne[longueur] = '\0';
+        debut += saut != NULL ? longueur + 1 : longueur;
+
+        if (client->chargement) {
+            if (longueur > 0 && ligne[longueur - 1] == '\r') ligne[--longueur] = '\0';
+            traiter_rangee_chargement(serveur, client, ligne, longueur);
+        } else {
+            traiter_requete(serveur, client, ligne);
         }
-        reinitialiser_couleur();
-        printf("\n");
     }
+
+    memmove(client->entree, client->entree + debut, client->taille_entree - debut);
+    client->taille_entree -= debut;
 }
 
 /**
- * traiter_option_n - l'option '-n' pour mettre à jour le statut de l'option, 
- * valider et créer un canvas avec les dimensions spécifiées.
+ * lire_client - Reçoit les octets disponibles sur la connexion d'un client.
  *
- * @param argc Nombre total d'arguments.
- * @param argv Tableau des arguments de la ligne de commande.
- * @param option_n_present Indicateur si l'option '-n' est présente.
- * @param canvas Pointeur vers le canvas à modifier.
- * @param i Indice courant dans argv, mis à jour après traitement.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @return int 1 si la connexion reste ouverte, 0 si elle doit être fermée.
  */
-void traiter_option_n(int argc, char *const *argv, unsigned int *option_n_present, struct canvas *canvas, int *i) {
-    (*option_n_present) = 1;
-    if ((*i) + 1 < argc) {
-        (*canvas) = recuperer_dimension_canvas(argv[(*i) + 1], "-n");
-        (*canvas) = creer_canvas(canvas, (*canvas).pen);
+int lire_client(Serveur *serveur, ClientServeur *client) {
+    // Réserve un octet pour terminer une dernière ligne sans saut de ligne
+    if (reserver_octets(&client->entree, &client->capacite_entree,
+                        client->taille_entree + TAILLE_BLOC_LECTURE / 16 + 1) != OK) {
+        return 0;
+    }
 
+    ssize_t recus = recv(client->descripteur, client->entree + client->taille_entree,
+                         client->capacite_entree - client->taille_entree - 1, 0);
+    if (recus < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if (recus == 0) {
+        client->fin_entree = 1;
     } else {
-        afficher_msg_valeur_manquante(argv[(*i)]);
+        client->taille_entree += recus;
     }
- 
-    (*i)++;
-}
 
+    traiter_entree_client(serveur, client);
+    if (client->taille_entree >= TAILLE_MAX_REQUETE) {
+        repondre_erreur(client, ERR_WITH_VALUE, "request");
+        client->fermeture = 1;
+    }
+    return 1;
+}
 
 /**
- * appliquer_config_canvas_option_h - Applique les configurations 
- * du canvas en fonction de l'option '-h'.
- * Lit le canvas depuis stdin si l'option '-n' n'est 
- * pas présente et imprime le canvas après traitement.
+ * ecrire_client - Envoie autant de réponses en attente que possible.
  *
- * @param argv Tableau des arguments de la ligne de commande.
- * @param option_n_present Indicateur de la présence de l'option '-n'.
- * @param canvas Canvas à configurer.
- * @param i Index de l'argument courant.
- * @return Le canvas modifié.
+ * @param serveur Pointeur vers le serveur.
+ * @param client Pointeur vers le client.
+ * @return int 1 si la connexion reste ouverte, 0 si elle doit être fermée.
  */
-
-struct canvas appliquer_config_canvas_option_h(char *const *argv, unsigned int option_n_present, struct canvas *canvas, int i) {
-    if (!option_n_present) {
-        lire_canvas_de_stdin(canvas);
-        traiter_option_h(canvas, argv[i + 1], "-h");
-        imprimer_canvas(canvas);
-    } else {
-        traiter_option_h(canvas, argv[i + 1], "-h");
+int ecrire_client(Serveur *serveur, ClientServeur *client) {
+    ssize_t envoyes = send(client->descripteur, client->sortie + client->octets_envoyes,
+                           client->taille_sortie - client->octets_envoyes, MSG_NOSIGNAL);
+
+    if (envoyes < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    client->octets_envoyes += envoyes;
+    if (client->octets_envoyes == client->taille_sortie) {
+        client->octets_envoyes = 0;
+        client->taille_sortie = 0;
     }
-    return (*canvas);
+    // Reprend les requêtes suspendues par un excès de réponses en attente
+    traiter_entree_client(serveur, client);
+    return 1;
 }
 
 /**
- * appliquer_config_canvas_option_v - Applique les configurations
- * du canvas en fonction de l'option '-v'.
- * Lit le canvas depuis stdin si l'option '-n' n'est 
- * pas présente et imprime le canvas après traitement.
+ * fermer_client - Ferme la connexion d'un client et libère son état.
  *
- * @param argv Tableau des arguments de la ligne de commande.
- * @param option_n_present Indicateur de la présence de l'option '-n'.
- * @param canvas Canvas à configurer.
- * @param i Index de l'argument courant.
- * @return Le canvas modifié.
+ * Le dernier client prend la place du client fermé.
+ *
+ * @param serveur Pointeur vers le serveur.
+ * @param indice Position du client dans la liste du serveur.
  */
-struct canvas appliquer_config_canvas_option_v(char *const *argv, unsigned int option_n_present, struct canvas *canvas, int i) {
-    if (!option_n_present) {
-        lire_canvas_de_stdin(canvas);
-        traiter_option_v(canvas, argv[i + 1], "-v");
-        imprimer_canvas(canvas);
-    } else {
-        traiter_option_v(canvas, argv[i + 1], "-v");
+void fermer_client(Serveur *serveur, size_t indice) {
+    ClientServeur *client = serveur->clients[indice];
+
+    close(client->descripteur);
+    free(client->entree);
+    free(client->sortie);
+    if (client->chargement) {
+        free(client->lecteur.reste);
+        liberer_canvas(&client->canvas_charge);
     }
-    return (*canvas);
+    free(client);
+    serveur->clients[indice] = serveur->clients[--serveur->nombre_clients];
 }
 
 /**
- * appliquer_config_canvas_option_r - Applique les configurations 
- * du canvas en fonction de l'option '-r' pour tracer un rectangle.
- * Lit le canvas depuis stdin si l'option '-n' 
- * n'est pas présente et imprime le canvas après traitement.
+ * accepter_clients - Accepte toutes les connexions en attente.
  *
- * @param argv Tableau des arguments de la ligne de commande.
- * @param option_n_present Indicateur de la présence de l'option '-n'.
- * @param canvas Canvas à configurer.
- * @param i Index de l'argument courant.
- * @param rectangle Structure pour stocker les paramètres du rectangle.
- * @return Le canvas modifié.
+ * @param serveur Pointeur vers le serveur.
  */
-struct canvas appliquer_config_canvas_option_r(char *const *argv, unsigned int option_n_present, struct canvas *canvas, int i,
-                                 Rectangle *rectangle) {
-    if (!option_n_present) {
-        lire_canvas_de_stdin(canvas);
-        (*rectangle) = recuperer_parametres_rectangle(argv[i+1], "-r");
-        tracer_rectangle((*rectangle), canvas);
-        imprimer_canvas(canvas);
-    } else {
-        (*rectangle) = recuperer_parametres_rectangle(argv[i + 1], "-r");
-        tracer_rectangle((*rectangle), canvas);
+void accepter_clients(Serveur *serveur) {
+    int descripteur;
+
+    while ((descripteur = accept(serveur->ecoute, NULL, NULL)) >= 0) {
+        ClientServeur *client = calloc(1, sizeof(ClientServeur));
+
+        if (client != NULL && serveur->nombre_clients == serveur->capacite_clients) {
+            size_t capacite = serveur->capacite_clients == 0 ? 16 : serveur->capacite_clients * 2;
+            ClientServeur **clients = realloc(serveur->clients, capacite * sizeof(ClientServeur *));
+            struct pollfd *attentes = realloc(serveur->attentes, (capacite + 1) * sizeof(struct pollfd));
+
+            if (clients != NULL) serveur->clients = clients;
+            if (attentes != NULL) serveur->attentes = attentes;
+            if (clients != NULL && attentes != NULL) serveur->capacite_clients = capacite;
+        }
+        if (client == NULL || serveur->nombre_clients == serveur->capacite_clients) {
+            free(client);
+            close(descripteur);
+            continue;
+        }
+        fcntl(descripteur, F_SETFL, fcntl(descripteur, F_GETFL) | O_NONBLOCK);
+        client->descripteur = descripteur;
+        serveur->clients[serveur->nombre_clients++] = client;
     }
-    return (*canvas);
 }
 
 /**
- * appliquer_config_canvas_option_c Applique les configurations 
- * du canvas en fonction de l'option '-c' pour tracer un cercle.
- * Lit le canvas depuis stdin si l'option '-n' 
- * n'est pas présente et imprime le canvas après traitement.
+ * ouvrir_socket_serveur - Crée le socket Unix d'écoute du serveur.
  *
- * @param argv Tableau des arguments de la ligne de commande.
- * @param option_n_present Indicateur de la présence de l'option '-n'.
- * @param canvas Canvas à configurer.
- * @param i Index de l'argument courant.
- * @param cercle Structure pour stocker les paramètres du cercle.
- * @return Le canvas modifié.
+ * Un ancien socket laissé au même chemin est remplacé; tout autre fichier
+ * est préservé.
+ *
+ * @param chemin Chemin du socket.
+ * @return int Descripteur du socket d'écoute, ou -1 en cas d'échec.
  */
-struct canvas appliquer_config_canvas_option_c(char *const *argv, unsigned int option_n_present, struct canvas *canvas, int i,
-                                 Cercle *cercle) {
-    if (!option_n_present) {
-        lire_canvas_de_stdin(canvas);
-        (*cercle) = recuperer_parametres_cercle(argv[i + 1], "-c");
-        tracer_cercle((*cercle), canvas);
-        imprimer_canvas(canvas);
-    } else {
-        (*cercle) = recuperer_parametres_cercle(argv[i + 1], "-c");
-        tracer_cercle((*cercle), canvas);
+int ouvrir_socket_serveur(const char *chemin) {
+    struct sockaddr_un adresse = {0};
+    struct stat etat;
+
+    if (strlen(chemin) >= sizeof(adresse.sun_path)) return -1;
+    adresse.sun_family = AF_UNIX;
+    strcpy(adresse.sun_path, chemin);
+    if (lstat(chemin, &etat) == 0 && S_ISSOCK(etat.st_mode)) unlink(chemin);
+
+    int descripteur = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (descripteur < 0) return -1;
+    if (bind(descripteur, (struct sockaddr *) &adresse, sizeof(adresse)) != 0
+            || listen(descripteur, SOMAXCONN) != 0) {
+        close(descripteur);
+        return -1;
     }
-    return (*canvas);
+    fcntl(descripteur, F_SETFL, fcntl(descripteur, F_GETFL) | O_NONBLOCK);
+    return descripteur;
 }
 
-
 /**
- * appliquer_config_canvas_option_l - Applique les configurations 
- * du canvas en fonction de l'option '-l' pour tracer un segment.
- * Lit le canvas depuis stdin si l'option '-n' 
- * n'est pas présente et trace le segment spécifié.
+ * preparer_attentes - Construit la liste des descripteurs à surveiller.
  *
- * @param argv Tableau des arguments de la ligne de commande.
- * @param option_n_present Indicateur de la présence de l'option '-n'.
- * @param canvas Canvas à configurer.
- * @param i Index de l'argument courant.
- * @param segment Structure pour stocker les paramètres du segment.
- * @return Le canvas modifié.
+ * Un client n'est lu que si ses réponses en attente restent sous
+ * SEUIL_SORTIE_CLIENT, et n'est surveillé en écriture que s'il a des
+ * réponses à recevoir.
+ *
+ * @param serveur Pointeur vers le serveur.
  */
-struct canvas
-appliquer_config_canvas_option_l(char *const *argv, unsigned int option_n_present, struct canvas *canvas, int i,
-                                 Segment *segment) {
-    if(!option_n_present) {
-        lire_canvas_de_stdin(canvas);
-        (*segment) = recuperer_parametres_segment(argv[i + 1], "-l");
-        tracer_segment((*segment), canvas);
-    } else {
-        (*segment) =  recuperer_parametres_segment(argv[i + 1], "-l");
-        tracer_segment((*segment), canvas);
+void preparer_attentes(Serveur *serveur) {
+    serveur->attentes[0] = (struct pollfd) {serveur->ecoute, POLLIN, 0};
+    for (size_t i = 0; i < serveur->nombre_clients; i++) {
+        ClientServeur *client = serveur->clients[i];
+        size_t en_attente = client->taille_sortie - client->octets_envoyes;
+        short evenements = 0;
+
+        if (!client->fin_entree && !client->fermeture && en_attente < SEUIL_SORTIE_CLIENT) {
+            evenements |= POLLIN;
+        }
+        if (en_attente > 0) evenements |= POLLOUT;
+        serveur->attentes[i + 1] = (struct pollfd) {client->descripteur, evenements, 0};
     }
-    return (*canvas);
 }
 
-
 /**
- * parser_arguments - Analyse les arguments de la ligne de commande pour configurer et manipuler un objet canvas.
- * Les options supportées incluent :
- * - "-n" pour traiter des options spécifiques de dimension du canvas.
- * - "-s" pour lire le canvas depuis l'entrée standard et l'imprimer.
- * - "-h", "-v", "-r", "-l", "-c" pour appliquer diverses configurations graphiques tracer une ligne horizontale, 
- *   verticale, un rectangle, un segmentt, et un cercle.
- * - "-p" pour choisir la couleur du stylo.
- * - "-k" pour lire le canvas de l'entrée standard et imprimer avec couleur, si '-n' n'est pas présent.
- * Gère également les erreurs d'options non reconnues 
- * qui nécessitent un argument supplémentaire.
- * @param argc Nombre total d'arguments.
- * @param argv Tableau des arguments de la ligne de commande.
+ * servir - Exécute le serveur de rendu sur un socket Unix.
+ *
+ * Un seul fil d'exécution multiplexe toutes les connexions avec poll : les
+ * canevas résidents sont partagés sans verrou et chaque requête est traitée
+ * en entier avant la suivante. Aucune requête ne termine le serveur; il
+ * s'arrête sur SIGINT ou SIGTERM en supprimant son socket.
+ *
+ * @param chemin Chemin du socket.
+ * @param limitee Borne les canevas créés ou chargés à 40x80 (sans -u).
  */
+void servir(char *chemin, int limitee) {
+    Serveur serveur = {0};
+    struct sigaction action = {0};
+
+    serveur.limitee = limitee;
+    serveur.ecoute = ouvrir_socket_serveur(chemin);
+    if (serveur.ecoute < 0) afficher_msg_erreur_valeur("--serve");
+    serveur.attentes = malloc(sizeof(struct pollfd));
+    if (serveur.attentes == NULL) afficher_msg_memoire_insuffisante();
+
+    action.sa_handler = demander_arret_serveur;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    while (!arret_serveur) {
+        preparer_attentes(&serveur);
+        if (poll(serveur.attentes, serveur.nombre_clients + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
 
-void parser_arguments(int argc, char *argv[]) {
-    unsigned int option_n_present = 0;
-    struct canvas canvas = {0};
-    canvas.pen = '7';
-    
-    for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "-n") == 0) {
-            traiter_option_n(argc, argv, &option_n_present, &canvas, &i);           
-        } else if (strcmp(argv[i], "-s") == 0) {
-            lire_canvas_de_stdin(&canvas);
-            imprimer_canvas(&canvas);
-        } else if (strcmp(argv[i], "-h") == 0) {
+        // Parcours à rebours : fermer un client ne déplace que des clients déjà traités
+        for (size_t i = serveur.nombre_clients; i-- > 0;) {
+            ClientServeur *client = serveur.clients[i];
+            short evenements = serveur.attentes[i + 1].revents;
+            int ouvert = 1;
 
-            if (i + 1 < argc) {
-                canvas = appliquer_config_canvas_option_h(argv, option_n_present, &canvas, i);
-                i++;
-            }
-        
-        } else if (strcmp(argv[i], "-v") == 0) {
+            if (evenements & (POLLIN | POLLHUP)) ouvert = lire_client(&serveur, client);
+            if (ouvert && (evenements & POLLOUT)) ouvert = ecrire_client(&serveur, client);
+            if (evenements & POLLERR) ouvert = 0;
 
-            if (i + 1 < argc) {
-                canvas = appliquer_config_canvas_option_v(argv, option_n_present, &canvas, i);
-                i++;
-            }
+            int termine = client->taille_sortie == 0
+                && (client->fermeture || (client->fin_entree && client->taille_entree == 0));
+            if (!ouvert || termine) fermer_client(&serveur, i);
+        }
+        if (serveur.attentes[0].revents & POLLIN) accepter_clients(&serveur);
+    }
 
-        } else if (strcmp(argv[i], "-r") == 0) {
-            Rectangle rectangle = {0};
-            if (i + 1 < argc) {
-                canvas = appliquer_config_canvas_option_r(argv, option_n_present, &canvas, i, &rectangle);
-                i++;
-            }
+    while (serveur.nombre_clients > 0) fermer_client(&serveur, serveur.nombre_clients - 1);
+    for (size_t i = 0; i < serveur.nombre_canevas; i++) liberer_canvas(&serveur.canevas[i].canvas);
+    free(serveur.canevas);
+    free(serveur.clients);
+    free(serveur.attentes);
+    close(serveur.ecoute);
+    unlink(chemin);
+}
 
-        } else if (strcmp(argv[i], "-l") == 0) {
-            Segment segment = {0};
-            if (i + 1 < argc) {
-                canvas = appliquer_config_canvas_option_l(argv, option_n_present, &canvas, i, &segment);
-                i++;
-            }
+/**
+ * relayer_reponses - Copie sur stdout les octets reçus du serveur.
+ *
+ * @param descripteur Socket connecté au serveur.
+ * @return int 1 si la connexion reste ouverte, 0 sinon.
+ */
+int relayer_reponses(int descripteur) {
+    char bloc[TAILLE_TAMPON_SORTIE];
+    ssize_t recus = recv(descripteur, bloc, sizeof(bloc), 0);
+
+    if (recus < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if (recus == 0) return 0;
+    fwrite(bloc, 1, recus, stdout);
+    fflush(stdout);
+    return 1;
+}
 
-        } else if (strcmp(argv[i], "-c") == 0) {
-            Cercle cercle = {0};
-            if (i + 1 < argc) {
-                canvas = appliquer_config_canvas_option_c(argv, option_n_present, &canvas, i, &cercle);
-                i++;
+/**
+ * envoyer_requetes - Envoie au serveur un bloc lu sur stdin.
+ *
+ * Continue de relayer les réponses pendant que le socket est plein, afin
+ * que le client et le serveur ne s'attendent jamais mutuellement.
+ *
+ * @param descripteur Socket connecté au serveur.
+ * @param octets Octets à envoyer.
+ * @param nombre Nombre d'octets.
+ * @return int 1 si la connexion reste ouverte, 0 sinon.
+ */
+int envoyer_requetes(int descripteur, const char *octets, size_t nombre) {
+    while (nombre > 0) {
+        ssize_t envoyes = send(descripteur, octets, nombre, MSG_NOSIGNAL);
+
+        if (envoyes >= 0) {
+            octets += envoyes;
+            nombre -= envoyes;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            struct pollfd attente = {descripteur, POLLIN | POLLOUT, 0};
+            if (poll(&attente, 1, -1) > 0 && (attente.revents & POLLIN)
+                    && !relayer_reponses(descripteur)) {
+                return 0;
             }
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
 
-        } else if (strcmp(argv[i], "-p")== 0) {
-            if (i + 1 < argc) {
-                canvas.pen = choisir_couleur(argv[i + 1], "-p");
-            } 
-            i++;
+/**
+ * executer_client - Relaie stdin vers un serveur de rendu et ses réponses vers stdout.
+ *
+ * À la fin de stdin, le côté écriture de la connexion est fermé et le
+ * client attend que le serveur ait envoyé toutes ses réponses.
+ *
+ * @param chemin Chemin du socket du serveur.
+ */
+void executer_client(char *chemin) {
+    struct sockaddr_un adresse = {0};
+    char bloc[TAILLE_TAMPON_SORTIE];
+    int entree_ouverte = 1;
+    int descripteur = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    adresse.sun_family = AF_UNIX;
+    if (descripteur < 0 || strlen(chemin) >= sizeof(adresse.sun_path)) afficher_msg_erreur_valeur("--client");
+    strcpy(adresse.sun_path, chemin);
+    if (connect(descripteur, (struct sockaddr *) &adresse, sizeof(adresse)) != 0) {
+        afficher_msg_erreur_valeur("--client");
+    }
+    fcntl(descripteur, F_SETFL, fcntl(descripteur, F_GETFL) | O_NONBLOCK);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (;;) {
+        struct pollfd attentes[2] = {
+            {entree_ouverte ? STDIN_FILENO : -1, POLLIN, 0},
+            {descripteur, POLLIN, 0}
+        };
+        if (poll(attentes, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
 
-        } else if (strcmp(argv[i], "-k") == 0) {
-            if (!option_n_present) {
-                lire_canvas_de_stdin(&canvas);
+        if (attentes[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t lus = read(STDIN_FILENO, bloc, sizeof(bloc));
+            if (lus <= 0) {
+                shutdown(descripteur, SHUT_WR);
+                entree_ouverte = 0;
+            } else if (!envoyer_requetes(descripteur, bloc, lus)) {
+                break;
             }
-
-            option_n_present = 0; // Flag pour eviter d'imprimer plus d'une fois
-            imprimer_canvas_couleur(&canvas);
-            i++;
-
-        } else {
-            afficher_msg_option_non_reconnue(argv[i]);
-            exit(ERR_UNRECOGNIZED_OPTION);
         }
+        if ((attentes[1].revents & (POLLIN | POLLHUP | POLLERR)) && !relayer_reponses(descripteur)) break;
     }
+    close(descripteur);
+}
 
-    if (option_n_present) imprimer_canvas(&canvas);
+/**
+ * parser_arguments - Analyse les arguments de la ligne de commande puis dessine.
+ *
+ * Le traitement se fait en phases successives : toutes les options sont
+ * d'abord analysées en une liste de commandes, le canevas est ensuite
+ * chargé une seule fois (-n ou stdin), les commandes sont appliquées dans
+ * l'ordre, puis le canevas est imprimé une seule fois, en couleur si -k
+ * est présent. Avec -j, le rendu et le formatage de la sortie sont
+ * répartis entre plusieurs threads.
+ * Les options supportées incluent :
+ * - "-n" pour créer un canevas vide plutôt que de le lire sur stdin.
+ * - "-s" pour imprimer le canevas en ignorant les options suivantes.
+ * - "-u" pour lever la limite de 40x80.
+ * - "-i" et "-o" pour charger et enregistrer un canevas binaire.
+ * - "--rle" pour imprimer le canevas encodé par plages.
+ * - "--stats" pour rapporter la durée des phases et les compteurs sur stderr.
+ * - "--tiled" pour stocker les pixels par tuiles.
+ * - "--packed" pour stocker les pixels sur 4 bits.
+ * - "-j" pour répartir le rendu et l'impression entre plusieurs threads.
+ * - "--incremental" pour ne réafficher que les pixels modifiés d'une image à l'autre.
+ * - "--fps" pour émettre les images des scripts à une cadence fixe.
+ * - "-h", "-v", "-r", "-l", "-c" pour tracer une ligne horizontale, verticale,
+ *   un rectangle, un segment et un cercle.
+ * - "-R", "-C" pour tracer un rectangle plein et un disque plein.
+ * - "-F" pour remplir une zone de même couleur.
+ * - "-p" pour choisir la couleur du stylo.
+ * - "-w" pour choisir l'épaisseur des rectangles, segments et cercles.
+ * - "-f" pour appliquer les commandes d'un fichier script.
+ * - "--compile" pour enregistrer les commandes en programme compilé, sans
+ *   charger de canevas ni dessiner.
+ * - "--run" pour rejouer un programme compilé.
+ * - "-k" pour imprimer avec les couleurs ANSI.
+ * - "--serve" et "--client" pour exécuter le serveur de rendu ou son client
+ *   au lieu de dessiner; les options de dessin sont alors ignorées.
+ *
+ * @param argc Nombre total d'arguments.
+ * @param argv Tableau des arguments de la ligne de commande.
+ */
+void parser_arguments(int argc, char *argv[]) {
+    Configuration configuration = {0};
+    struct canvas canvas = {0};
+
+    if (argc < 2) return;
+
+    clock_gettime(CLOCK_MONOTONIC, &configuration.statistiques.debut_phase);
+    analyser_arguments(argc, argv, &configuration);
+    rapporter_phase(&configuration.statistiques, &canvas, "arguments");
+    if (configuration.socket_serveur != NULL || configuration.socket_client != NULL) {
+        if (configuration.socket_serveur != NULL) servir(configuration.socket_serveur, !configuration.illimite);
+        else executer_client(configuration.socket_client);
+        liberer_commandes(&configuration.commandes);
+        return;
+    }
+    if (configuration.programme_compile != NULL) {
+        struct stat etat;
+
+        compiler_programme(&configuration);
+        if (stat(configuration.programme_compile, &etat) == 0) configuration.statistiques.octets_ecrits += etat.st_size;
+        rapporter_phase(&configuration.statistiques, &canvas, "compile, %llu bytes read",
+                        configuration.statistiques.octets_lus);
+        rapporter_statistiques(&configuration.statistiques, &canvas);
+        liberer_commandes(&configuration.commandes);
+        return;
+    }
+    charger_canvas(&configuration, &canvas);
+    rapporter_phase(&configuration.statistiques, &canvas, "load, %llu bytes read",
+                    configuration.statistiques.octets_lus);
+    executer_commandes(&canvas, &configuration);
+    if (configuration.fichier_sortie != NULL) {
+        struct stat etat;
+
+        decoder_rangees(&canvas, 0, canvas.height);
+        enum error erreur = enregistrer_canvas_binaire(&canvas, configuration.fichier_sortie);
+        if (erreur != OK) signaler_erreur_option(erreur, "-o");
+        if (stat(configuration.fichier_sortie, &etat) == 0) configuration.statistiques.octets_ecrits += etat.st_size;
+    } else {
+        emettre_canvas(&canvas, &configuration, 1);
+    }
+    rapporter_phase(&configuration.statistiques, &canvas, "output");
+    rapporter_statistiques(&configuration.statistiques, &canvas);
 
+    liberer_commandes(&configuration.commandes);
+    liberer_canvas(&canvas);
 }
 
 /**
@@ -1273,5 +2099,3 @@ int main(int argc, char *argv[]) {
     parser_arguments(argc, argv);
     return OK;
 }
-   
-
@@ -0,0 +1,93 @@
+/**
+ * Projet Canvascii - Interface publique de libcanvascii
+ *
+ * Ce fichier, canvascii.h, décrit la bibliothèque de dessin sur un
+ * canevas ASCII utilisée par la ligne de commande canvascii, pour les
+ * programmes qui veulent dessiner sans lancer un processus par image.
+ *
+ * Un canevas est manipulé par un pointeur opaque, créé par
+ * canvascii_creer, canvascii_lire ou canvascii_charger et détruit par
+ * canvascii_liberer. Les tracés le modifient en place. Aucune fonction
+ * n'affiche de message ni ne termine le programme : chacune retourne un
+ * enum error, OK en cas de succès. Les coordonnées suivent celles de la
+ * ligne de commande (rangée puis colonne) et les formes sont rognées au
+ * canevas. Des canevas distincts peuvent être utilisés en même temps par
+ * des threads distincts.
+ *
+ * Les dimensions ne sont pas limitées à 40x80, contrairement à la ligne
+ * de commande sans -u.
+ *
+ */
+
+#ifndef CANVASCII_H
+#define CANVASCII_H
+
+#include <stdio.h>
+
+#if defined(__GNUC__)
+#define CANVASCII_API __attribute__((visibility("default")))
+#else
+#define CANVASCII_API
+#endif
+
+#define DISPOSITION_TUILES 1              // Pixels stockés par tuiles (--tiled)
+#define DISPOSITION_COMPACTE 2            // Pixels stockés sur 4 bits (--packed)
+
+enum error {
+    OK                         = 0, // Everything is ok
+    ERR_WRONG_PIXEL            = 1, // Wrong pixel value in canvas
+    ERR_CANVAS_TOO_HIGH        = 2, // Canvas is too high
+    ERR_CANVAS_TOO_WIDE        = 3, // Canvas is too wide
+    ERR_CANVAS_NON_RECTANGULAR = 4, // Canvas is non rectangular
+    ERR_UNRECOGNIZED_OPTION    = 5, // Unrecognized option
+    ERR_MISSING_VALUE          = 6, // Option with missing value
+    ERR_WITH_VALUE             = 7, // Problem with value
+    ERR_OUT_OF_MEMORY          = 8  // Canvas could not be allocated
+};
+
+enum format_impression {
+    FORMAT_TEXTE,           // Une ligne de pixels par rangée
+    FORMAT_COULEUR,         // Pixels colorés avec les séquences ANSI (-k)
+    FORMAT_RLE              // Plages de pixels identiques (--rle)
+};
+
+struct canvas;
+
+// Création et destruction; disposition combine DISPOSITION_TUILES et DISPOSITION_COMPACTE
+CANVASCII_API enum error canvascii_creer(unsigned int hauteur, unsigned int largeur,
+                                         unsigned int disposition, struct canvas **canvas);
+CANVASCII_API enum error canvascii_lire(FILE *flux, unsigned int disposition, struct canvas **canvas);
+CANVASCII_API enum error canvascii_charger(const char *chemin, struct canvas **canvas);
+CANVASCII_API void canvascii_liberer(struct canvas *canvas);
+
+// Consultation
+CANVASCII_API unsigned int canvascii_hauteur(const struct canvas *canvas);
+CANVASCII_API unsigned int canvascii_largeur(const struct canvas *canvas);
+CANVASCII_API enum error canvascii_pixel(struct canvas *canvas, unsigned int rangee,
+                                         unsigned int colonne, char *pixel);
+
+// Tracés
+CANVASCII_API enum error canvascii_choisir_crayon(struct canvas *canvas, char crayon);
+CANVASCII_API enum error canvascii_choisir_epaisseur(struct canvas *canvas, unsigned int epaisseur);
+CANVASCII_API enum error canvascii_ligne_horizontale(struct canvas *canvas, unsigned int rangee);
+CANVASCII_API enum error canvascii_ligne_verticale(struct canvas *canvas, unsigned int colonne);
+CANVASCII_API enum error canvascii_rectangle(struct canvas *canvas, int rangee, int colonne,
+                                             unsigned int hauteur, unsigned int largeur);
+CANVASCII_API enum error canvascii_rectangle_plein(struct canvas *canvas, int rangee, int colonne,
+                                                   unsigned int hauteur, unsigned int largeur);
+CANVASCII_API enum error canvascii_segment(struct canvas *canvas, int rangee1, int colonne1,
+                                           int rangee2, int colonne2);
+CANVASCII_API enum error canvascii_cercle(struct canvas *canvas, int rangee, int colonne, unsigned int rayon);
+CANVASCII_API enum error canvascii_disque(struct canvas *canvas, int rangee, int colonne, unsigned int rayon);
+CANVASCII_API enum error canvascii_remplir(struct canvas *canvas, unsigned int rangee, unsigned int colonne);
+CANVASCII_API enum error canvascii_polyligne(struct canvas *canvas, const int *sommets, unsigned int nombre);
+CANVASCII_API enum error canvascii_polygone(struct canvas *canvas, const int *sommets, unsigned int nombre);
+CANVASCII_API enum error canvascii_polygone_plein(struct canvas *canvas, const int *sommets,
+                                                 unsigned int nombre);
+CANVASCII_API enum error canvascii_appliquer(struct canvas *canvas, const char *option, const char *valeur);
+
+// Sorties
+CANVASCII_API enum error canvascii_imprimer(struct canvas *canvas, FILE *flux, enum format_impression format);
+CANVASCII_API enum error canvascii_enregistrer(struct canvas *canvas, const char *chemin);
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ * Projet Canvascii - Déclarations internes de libcanvascii
+ *
+ * Ce fichier, canvascii_interne.h, partage entre la bibliothèque
+ * (libcanvascii.c) et la ligne de commande (canvascii.c) la structure des
+ * canevas, les commandes de dessin et les routines de la bibliothèque que
+ * la ligne de commande appelle directement. Il ne fait pas partie de
+ * l'interface publique, décrite dans canvascii.h.
+ *
+ */
+
+#ifndef CANVASCII_INTERNE_H
+#define CANVASCII_INTERNE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "canvascii.h"
+
+#define MAX_HEIGHT 40
+#define MAX_WIDTH 80
+#define TAILLE_TAMPON_SORTIE (64 * 1024) // Taille du tampon de formatage de la sortie
+#define TAILLE_BLOC_LECTURE (1024 * 1024) // Taille des blocs lus sur stdin
+#define MAX_THREADS 64                    // Nombre maximal de threads de rendu (-j)
+
+typedef struct {
+    unsigned int debut;     // Première colonne modifiée (incluse)
+    unsigned int fin;       // Dernière colonne modifiée (exclue), debut == fin si aucune
+} PlageModifiee;
+
+typedef struct {
+    unsigned long commandes;        // Commandes appliquées
+    unsigned long long pixels;      // Pixels écrits par ces commandes
+} CompteurTrace;
+
+typedef struct {
+    char *donnees;          // Texte RLE lu sur stdin, chaque rangée terminée par '\0'
+    size_t capacite;        // Octets alloués pour donnees
+    size_t *debuts;         // Position de chaque rangée dans donnees
+    unsigned char *decodee; // Rangées déjà décodées dans les pixels
+} SourceRLE;
+
+struct canvas {
+    char *pixels;           // A contiguous, aligned buffer of pixels
+    size_t stride;          // Number of bytes between two consecutive rows
+    unsigned int width;     // Its width
+    unsigned int height;    // Its height
+    char pen;               // The character we are drawing with
+    unsigned int epaisseur; // Width of the -r, -l and -c strokes (-w), 0 or 1 for thin strokes
+    int tiled;              // Pixels are stored in square tiles instead of rows
+    int packed;             // Pixels are stored as 4-bit codes, two per byte
+    PlageModifiee *modifs;  // Columns changed in each row since the last frame, or NULL
+    char *projection;       // Binary file mapped in memory holding the pixels, or NULL
+    size_t taille_projection; // Size of the mapping in bytes
+    SourceRLE *rle;         // RLE rows not yet decoded into the pixels, or NULL
+    unsigned long long pixels_ecrits; // Pixels written by the drawing routines
+    char *rangee_lue;       // Contiguous row for lire_rangee (tiled or packed), or NULL
+    CompteurTrace *compteurs; // Commands and pixels per command type (--stats), or NULL
+    int limitee;            // Dimensions bounded by MAX_HEIGHT x MAX_WIDTH (set by the command line)
+};
+
+typedef struct {
+    int x;
+    int y;
+} Coordonnees;
+
+typedef struct {
+    Coordonnees position;      
+    unsigned int height;
+    unsigned int width;
+} Rectangle;
+
+typedef struct {
+    Coordonnees pointA;
+    Coordonnees pointB;
+} Segment;
+
+typedef struct {
+    long rangee_debut;      // Première rangée visible (incluse)
+    long rangee_fin;        // Dernière rangée visible (exclue)
+    long colonne_debut;     // Première colonne visible (incluse)
+    long colonne_fin;       // Dernière colonne visible (exclue)
+} Fenetre;
+
+typedef struct {
+    int ROW;
+    int COL;
+    unsigned int rayon;
+} Cercle;
+
+typedef struct {
+    Coordonnees *sommets;   // Sommets dans l'ordre, x étant la rangée
+    unsigned int nombre;    // Nombre de sommets
+} Polygone;
+
+enum type_commande {
+    COMMANDE_CRAYON,          // -p : change le crayon
+    COMMANDE_HORIZONTALE,     // -h : ligne horizontale
+    COMMANDE_VERTICALE,       // -v : ligne verticale
+    COMMANDE_RECTANGLE,       // -r : rectangle
+    COMMANDE_SEGMENT,         // -l : segment
+    COMMANDE_CERCLE,          // -c : cercle
+    COMMANDE_RECTANGLE_PLEIN, // -R : rectangle plein
+    COMMANDE_DISQUE,          // -C : disque plein
+    COMMANDE_REMPLISSAGE,     // -F : remplissage d'une zone
+    COMMANDE_EPAISSEUR,       // -w : change l'épaisseur des traits
+    COMMANDE_POLYLIGNE,       // -L : ligne brisée
+    COMMANDE_POLYGONE,        // -P : contour d'un polygone
+    COMMANDE_POLYGONE_PLEIN,  // -A : polygone plein
+    COMMANDE_AFFICHAGE,       // s  : émission d'une image, dans un script seulement
+    COMMANDE_SCRIPT,          // -f : fichier de commandes
+    COMMANDE_PROGRAMME        // --run : programme compilé par --compile
+};
+
+typedef struct programme Programme;
+
+typedef struct {
+    enum type_commande type;
+    char *option;               // Option d'origine, pour les messages d'erreur
+    union {
+        char crayon;
+        unsigned int indice;    // Rangée (-h) ou colonne (-v)
+        unsigned int epaisseur; // Épaisseur des traits (-w)
+        Rectangle rectangle;
+        Segment segment;
+        Cercle cercle;
+        Polygone polygone;      // Sommets de -L, -P et -A, alloués par l'analyse
+        Coordonnees germe;      // Point de départ du remplissage (-F), x étant la rangée
+        char *fichier;          // Chemin du script (-f), "-" pour stdin
+        Programme *programme;   // Programme compilé chargé (--run)
+    } parametres;
+} Commande;
+
+struct programme {
+    const char *chemin;         // Fichier d'où le programme a été chargé
+    Commande *commandes;        // Commandes validées, crayons compris, sans script
+    size_t nombre;              // Nombre de commandes
+};
+
+typedef struct {
+    struct canvas *canvas;      // Canevas en cours de remplissage
+    unsigned int capacite;      // Nombre de rangées allouées
+    char *reste;                // Rangée incomplète à la fin du bloc précédent
+    size_t taille_reste;        // Nombre d'octets dans reste
+    size_t capacite_reste;      // Capacité de reste
+    char pixel_invalide;        // Premier pixel invalide rencontré
+} LecteurCanvas;
+
+typedef struct {
+    char *donnees;          // Zone de formatage réutilisable d'une trame à l'autre
+    size_t taille;          // Nombre d'octets en attente dans la zone
+    size_t capacite;        // Capacité de la zone
+    FILE *flux;             // Flux de destination
+    size_t octets_ecrits;   // Total des octets transmis au flux
+} TamponSortie;
+
+// Option de chaque type de commande, pour les messages et les rapports
+extern char *const OPTIONS_COMMANDES[];
+
+// Routines de libcanvascii.c utilisées par la ligne de commande et par bench.c
+enum error convertir_entier(const char *valeur, int *resultat);
+int est_negatif(int nombre);
+enum error verifier_dimensions(const struct canvas *canvas, unsigned int longueur, unsigned int largeur);
+void liberer_canvas(struct canvas *canvas);
+char *rangee_canvas(const struct canvas *canvas, unsigned int rangee);
+size_t nombre_rangees_stockees(const struct canvas *canvas);
+enum error allouer_canvas(struct canvas *canvas);
+enum error disposer_en_tuiles(struct canvas *canvas);
+enum error creer_canvas(struct canvas *canvas, char couleur);
+int est_valeur_absente(const char *valeur);
+size_t imprimer_canvas(struct canvas *canvas, FILE *flux);
+size_t imprimer_canvas_rle(struct canvas *canvas, FILE *flux);
+void initialiser_lecteur_canvas(LecteurCanvas *lecteur, struct canvas *canvas);
+enum error ajouter_rangee_lue(LecteurCanvas *lecteur, const char *ligne, size_t longueur);
+enum error terminer_lecture_canvas(LecteurCanvas *lecteur);
+enum error lire_canvas(FILE *flux, struct canvas *canvas, size_t *octets_lus, char *pixel_invalide);
+enum error lire_canvas_rle(FILE *flux, struct canvas *canvas, size_t *octets_lus, char *pixel_invalide);
+enum error charger_canvas_binaire(struct canvas *canvas, const char *chemin);
+enum error enregistrer_canvas_binaire(const struct canvas *canvas, const char *chemin);
+void decoder_rangees(struct canvas *canvas, long rangee_debut, long rangee_fin);
+Fenetre fenetre_canvas(const struct canvas *canvas);
+size_t imprimer_canvas_couleur(struct canvas *canvas, FILE *flux);
+size_t imprimer_canvas_parallele(struct canvas *canvas, FILE *flux, int couleur,
+                                 unsigned int nombre_threads);
+enum error suivre_modifications(struct canvas *canvas);
+size_t imprimer_modifications(struct canvas *canvas, FILE *flux, int couleur, int premiere);
+enum error analyser_commande(char *option, char *valeur, Commande *commande);
+void liberer_commande(Commande *commande);
+enum error verifier_commande(const struct canvas *canvas, const Commande *commande);
+enum error appliquer_commande(struct canvas *canvas, const Commande *commande, const Fenetre *fenetre);
+enum error executer_commande(struct canvas *canvas, const Commande *commande);
+enum error executer_lot_parallele(struct canvas *canvas, const Commande *commandes, size_t nombre,
+                                  unsigned int nombre_threads, size_t *fautive);
+enum error enregistrer_programme(const Commande *commandes, size_t nombre, const char *chemin);
+enum error charger_programme(Programme *programme, const char *chemin);
+void liberer_programme(Programme *programme);
+
+#endif
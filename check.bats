@@ -22,6 +22,78 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "$status" -eq 0 ]
 }
 
+@test "Option -u lifts the 40x80 limit with option -n" {
+    run ./$prog -u -n 50,100
+    [ "$status" -eq 0 ]
+    [ "${#lines[@]}" -eq 50 ]
+    [ "${#lines[49]}" -eq 100 ]
+}
+
+@test "Option -u allows loading a canvas of 41 lines" {
+    run ./$prog -u -s < $examples_folder/too-high.canvas
+    [ "$status" -eq 0 ]
+    [ "${#lines[@]}" -eq 41 ]
+}
+
+@test "Loading a canvas larger than one read block" {
+    run bash -c "yes ........ | head -n 200000 | ./$prog -u -s | wc -l"
+    [ "$status" -eq 0 ]
+    [ "$output" -eq 200000 ]
+}
+
+@test "Option --tiled draws and prints like the row layout" {
+    options="-u -n 70,130 -v 66 -h 65 -C 30,60,40 -l 0,0,69,129 -R 60,100,20,40"
+    run bash -c "diff <(./$prog $options) <(./$prog --tiled $options) && \
+        ./$prog --tiled -s < $examples_folder/all-pens5x8.canvas | diff - $examples_folder/all-pens5x8.canvas"
+    [ "$status" -eq 0 ]
+}
+
+@test "Option --packed draws and prints like one byte per pixel" {
+    options="-u -n 70,131 -v 65 -h 66 -C 30,60,40 -l 0,0,69,130 -R 60,101,9,30"
+    run bash -c "diff <(./$prog $options) <(./$prog --packed $options) && \
+        diff <(./$prog $options) <(./$prog --packed --tiled $options) && \
+        ./$prog --packed -s < $examples_folder/all-pens5x8.canvas | diff - $examples_folder/all-pens5x8.canvas"
+    [ "$status" -eq 0 ]
+}
+
+@test "Option -j renders and prints like a single thread" {
+    options="-u -n 70,131 -v 65 -p 3 -h 66 -C 30,60,40 -p 1 -l 0,0,69,130 -R 60,101,9,30 -c 35,65,34"
+    run bash -c "diff <(./$prog $options) <(./$prog -j 4 $options) && \
+        diff <(./$prog $options) <(./$prog -j 64 --tiled --packed $options) && \
+        diff <(./$prog -k $options) <(./$prog -j 3 -k $options)"
+    [ "$status" -eq 0 ]
+}
+
+@test "Options -o and -i convert to and from the binary format" {
+    run bash -c "f=\$(mktemp) && ./$prog --packed -o \$f < $examples_folder/all-pens5x8.canvas && \
+        head -c 8 \$f && echo && ./$prog -i \$f -h 0 && rm \$f"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "CANVASCI" ]
+    [ "${lines[1]}" = "77777777" ]
+    [ "${lines[2]}" = ".0..2.1." ]
+    [ "${lines[3]}" = "...3...." ]
+    [ "${lines[4]}" = ".4...5.." ]
+    [ "${lines[5]}" = "...6...." ]
+}
+
+@test "Options -o and -i keep a canvas without columns" {
+    run bash -c "f=\$(mktemp) && printf '' | ./$prog -o \$f && ./$prog -i \$f -s && \
+        printf '\\n\\n' | ./$prog --tiled -o \$f && ./$prog -i \$f -s && rm \$f"
+    [ "$status" -eq 0 ]
+    [ "${#lines[@]}" -eq 0 ]
+}
+
+@test "Option --rle encodes the canvas and draws on it when read back" {
+    run bash -c "./$prog --rle < $examples_folder/all-pens5x8.canvas | tee /dev/stderr | ./$prog --packed -h 4"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "RLE 5,8" ]
+    [ "${lines[1]}" = "3. 7 4." ]
+    [ "${lines[2]}" = ". 0 2. 2 . 1 ." ]
+    [ "${lines[6]}" = "...7...." ]
+    [ "${lines[7]}" = ".0..2.1." ]
+    [ "${lines[10]}" = "77777777" ]
+}
+
 @test "Loading and prints an empty 5x8 canvas" {
     run ./$prog -s < $examples_folder/empty5x8.canvas
     [ "$status" -eq 0 ]
@@ -82,6 +154,82 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "${lines[4]}" = "..777..." ]
 }
 
+@test "Drawing filled rectangle on 5x8 canvas with option -R" {
+    run ./$prog -R 1,2,3,4 < examples/empty5x8.canvas
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "........" ]
+    [ "${lines[1]}" = "..7777.." ]
+    [ "${lines[2]}" = "..7777.." ]
+    [ "${lines[3]}" = "..7777.." ]
+    [ "${lines[4]}" = "........" ]
+}
+
+@test "Drawing filled disc on 5x8 canvas with option -C" {
+    run ./$prog -C 2,3,2 < examples/empty5x8.canvas
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "..777..." ]
+    [ "${lines[1]}" = ".77777.." ]
+    [ "${lines[2]}" = ".77777.." ]
+    [ "${lines[3]}" = ".77777.." ]
+    [ "${lines[4]}" = "..777..." ]
+}
+
+@test "Filling areas on 5x8 canvas with option -F" {
+    run bash -c "./$prog -n 5,8 -r 0,0,5,5 -l 0,0,4,4 -p 2 -F 1,3 -p 3 -F 0,7 && \
+                 ./$prog -n 5,8 -r 0,0,5,5 -l 0,0,4,4 -p 2 -F 1,3 -p 3 -F 0,7 -j 3 --packed"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "77777333" ]
+    [ "${lines[1]}" = "77227333" ]
+    [ "${lines[2]}" = "7.727333" ]
+    [ "${lines[3]}" = "7..77333" ]
+    [ "${lines[4]}" = "77777333" ]
+    [ "${lines[5]}" = "77777333" ]
+    [ "${lines[6]}" = "77227333" ]
+    [ "${lines[7]}" = "7.727333" ]
+    [ "${lines[8]}" = "7..77333" ]
+    [ "${lines[9]}" = "77777333" ]
+}
+
+@test "Drawing thick strokes on 7x9 canvas with option -w" {
+    run bash -c "./$prog -n 7,9 -w 2 -c 3,4,2 -p 1 -w 3 -l 0,0,6,1 && \
+                 ./$prog -n 7,9 -w 2 -c 3,4,2 -p 1 -w 3 -l 0,0,6,1 -j 3 --tiled"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "11.777..." ]
+    [ "${lines[1]}" = "1177777.." ]
+    [ "${lines[2]}" = "1177.777." ]
+    [ "${lines[3]}" = "117...77." ]
+    [ "${lines[4]}" = "1177.777." ]
+    [ "${lines[5]}" = "1177777.." ]
+    [ "${lines[6]}" = "111777..." ]
+    [ "${lines[7]}" = "11.777..." ]
+    [ "${lines[8]}" = "1177777.." ]
+    [ "${lines[9]}" = "1177.777." ]
+    [ "${lines[10]}" = "117...77." ]
+    [ "${lines[11]}" = "1177.777." ]
+    [ "${lines[12]}" = "1177777.." ]
+    [ "${lines[13]}" = "111777..." ]
+}
+
+@test "Drawing polylines and polygons with options -L, -P and -A" {
+    run bash -c "./$prog -n 7,16 -L 6,0,0,2,6,4 -p 2 -P 0,6,6,6,3,9 -p 3 -A 0,10,6,10,3,12,6,15,0,15 && \
+                 ./$prog -n 7,16 -L 6,0,0,2,6,4 -p 2 -P 0,6,6,6,3,9 -p 3 -A 0,10,6,10,3,12,6,15,0,15 -j 3 --packed"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = ".77...22..333333" ]
+    [ "${lines[1]}" = ".77...222.333333" ]
+    [ "${lines[2]}" = ".77...2.22333333" ]
+    [ "${lines[3]}" = "77.7..2.22333333" ]
+    [ "${lines[4]}" = "7..7..222.33.333" ]
+    [ "${lines[5]}" = "7..7..22..3...33" ]
+    [ "${lines[6]}" = "7...7.2...3....3" ]
+    [ "${lines[7]}" = ".77...22..333333" ]
+    [ "${lines[8]}" = ".77...222.333333" ]
+    [ "${lines[9]}" = ".77...2.22333333" ]
+    [ "${lines[10]}" = "77.7..2.22333333" ]
+    [ "${lines[11]}" = "7..7..222.33.333" ]
+    [ "${lines[12]}" = "7..7..22..3...33" ]
+    [ "${lines[13]}" = "7...7.2...3....3" ]
+}
+
 @test "Combining multiple options" {
     run ./$prog -n 5,5 -p 1 -l 0,0,4,4 -p 7 -l 0,4,4,0 -p 2 -r 0,0,5,5
     [ "$status" -eq 0 ]
@@ -92,6 +240,166 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "${lines[4]}" = "22222" ]
 }
 
+@test "Combining multiple options on a canvas read from stdin" {
+    run ./$prog -h 1 -v 2 -p 3 -r 0,0,3,3 < $examples_folder/empty5x8.canvas
+    [ "$status" -eq 0 ]
+    [ "${#lines[@]}" -eq 5 ]
+    [ "${lines[0]}" = "333....." ]
+    [ "${lines[1]}" = "37377777" ]
+    [ "${lines[2]}" = "333....." ]
+    [ "${lines[3]}" = "..7....." ]
+    [ "${lines[4]}" = "..7....." ]
+}
+
+@test "Applying drawing commands from a script with option -f" {
+    run bash -c "printf 'p 1\nl 0,0,4,4\n# comment\n\np 2\nr 0,0,5,5\n' | ./$prog -n 5,5 -f - 2> /dev/null"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "22222" ]
+    [ "${lines[1]}" = "21..2" ]
+    [ "${lines[2]}" = "2.1.2" ]
+    [ "${lines[3]}" = "2..12" ]
+    [ "${lines[4]}" = "22222" ]
+}
+
+@test "Option -f reports its throughput on stderr" {
+    run bash -c "printf 'h 1\nv 1\n' | ./$prog -n 3,3 -f - 2>&1 > /dev/null"
+    [ "$status" -eq 0 ]
+    [[ "${lines[0]}" == "Script -: 2 commands in "*" commands/s)" ]]
+}
+
+@test "Options --compile and --run replay a script without parsing it" {
+    run bash -c "f=\$(mktemp) && printf 'p 1\nl 0,0,4,4\np 2\nr 0,0,5,5\n' | ./$prog --compile \$f -f - -C 2,2,1 && \
+                 ./$prog -n 5,5 --run \$f 2> /dev/null && ./$prog -n 3,3 -j 2 --run \$f 2> /dev/null; rm -f \$f"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "22222" ]
+    [ "${lines[1]}" = "212.2" ]
+    [ "${lines[2]}" = "22222" ]
+    [ "${lines[3]}" = "2.212" ]
+    [ "${lines[4]}" = "22222" ]
+    [ "${lines[5]}" = "222" ]
+    [ "${lines[6]}" = "212" ]
+    [ "${lines[7]}" = "222" ]
+}
+
+@test "Option --incremental repaints only the changed pixels" {
+    run bash -c "printf 'h 1\ns\np 2\nl 0,2,1,3\n' | ./$prog -n 2,4 --incremental -f - 2> /dev/null | od -An -c | tr -d ' \n'"
+    [ "$status" -eq 0 ]
+    [ "$output" = '033[2J033[1;1H....033[2;1H7777033[3;1H033[1;3H2033[2;4H2033[3;1H' ]
+}
+
+@test "Option --fps paces the frames and reports their latency" {
+    run bash -c "printf 'h 0\ns\nh 1\n' | ./$prog -n 2,3 --fps 100 -f - 2>&1 > /dev/null"
+    [ "$status" -eq 0 ]
+    [[ "${lines[0]}" == "Frame 1: "*" ms latency" ]]
+    [[ "${lines[2]}" == "Frame 2: "*" ms latency" ]]
+    [[ "${lines[3]}" == "Animation: 2 frames at 100 fps, "*" dropped, latency "*" ms max" ]]
+}
+
+@test "Option --stats reports phase times and counters on stderr" {
+    run bash -c "./$prog -n 2,3 --stats -h 0 -l 0,0,1,2 2>&1 > /dev/null"
+    [ "$status" -eq 0 ]
+    [[ "${lines[0]}" == "Stats: arguments: "*" ms" ]]
+    [[ "${lines[1]}" == "Stats: load, 0 bytes read: "*" ms" ]]
+    [[ "${lines[2]}" == "Stats: command 1 (-h), 3 pixels: "*" ms" ]]
+    [[ "${lines[3]}" == "Stats: command 2 (-l), 3 pixels: "*" ms" ]]
+    [[ "${lines[4]}" == "Stats: output: "*" ms" ]]
+    [ "${lines[5]}" = "Stats: -h: 1 commands, 3 pixels written" ]
+    [ "${lines[6]}" = "Stats: -l: 1 commands, 3 pixels written" ]
+    [ "${lines[7]}" = "Stats: 6 pixels written, 0 bytes read, 8 bytes written" ]
+    [[ "${lines[8]}" == "Stats: peak canvas memory "*" bytes, peak resident memory "*" KB" ]]
+}
+
+@test "Option --stats counts every pixel of an upward diagonal" {
+    run bash -c "f=\$(mktemp) && for j in 1 4; do \
+        ./$prog -n 12,22 -j \$j --stats -l 10,10,0,20 2> \$f | tr -cd 7 | wc -c; \
+        grep '^Stats: -l:' \$f; done; rm \$f"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" -eq 21 ]
+    [ "${lines[1]}" = "Stats: -l: 1 commands, 21 pixels written" ]
+    [ "${lines[2]}" -eq 21 ]
+    [ "${lines[3]}" = "Stats: -l: 1 commands, 21 pixels written" ]
+}
+
+@test "Library libcanvascii draws in-process and returns error codes" {
+    dir=$(mktemp -d)
+    cat > $dir/dessin.c <<'EOF'
+#include "canvascii.h"
+int main(void) {
+    struct canvas *canvas;
+    if (canvascii_creer(3, 5, DISPOSITION_COMPACTE, &canvas) != OK) return 1;
+    canvascii_choisir_crayon(canvas, '2');
+    canvascii_rectangle(canvas, 0, 0, 3, 5);
+    printf("%d %d\n", canvascii_ligne_horizontale(canvas, 3), canvascii_appliquer(canvas, "-x", "1"));
+    canvascii_imprimer(canvas, stdout, FORMAT_TEXTE);
+    canvascii_liberer(canvas);
+    printf("%d\n", canvascii_creer(41, 81, 0, &canvas));
+    canvascii_liberer(canvas);
+    return 0;
+}
+EOF
+    run bash -c "gcc -std=c11 -I. $dir/dessin.c libcanvascii.a -o $dir/dessin -pthread && $dir/dessin"
+    rm -rf $dir
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "7 5" ]
+    [ "${lines[1]}" = "22222" ]
+    [ "${lines[2]}" = "2...2" ]
+    [ "${lines[3]}" = "22222" ]
+    [ "${lines[4]}" = "0" ]
+}
+
+@test "Drawing on resident canvases with options --serve and --client" {
+    run bash -c "sock=\$(mktemp -u); ./$prog --serve \$sock & \
+        while [ ! -S \$sock ]; do sleep 0.1; done; \
+        printf 'new a 3,5\ndraw a -p 1 -h 1\nload b\n.2\n3.\n\nlist\nprint a\n' | ./$prog --client \$sock; \
+        printf 'draw a -v 4\nprint a\n' | ./$prog --client \$sock; \
+        kill \$!; wait"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "OK 3,5" ]
+    [ "${lines[1]}" = "OK 2" ]
+    [ "${lines[2]}" = "OK 2,2" ]
+    [ "${lines[3]}" = "OK 2" ]
+    [ "${lines[4]}" = "a 3,5" ]
+    [ "${lines[5]}" = "b 2,2" ]
+    [ "${lines[6]}" = "OK 3,5" ]
+    [ "${lines[7]}" = "....." ]
+    [ "${lines[8]}" = "11111" ]
+    [ "${lines[9]}" = "....." ]
+    [ "${lines[10]}" = "OK 1" ]
+    [ "${lines[11]}" = "OK 3,5" ]
+    [ "${lines[12]}" = "....1" ]
+    [ "${lines[13]}" = "11111" ]
+    [ "${lines[14]}" = "....1" ]
+}
+
+@test "Bad requests to option --serve get an error reply" {
+    run bash -c "sock=\$(mktemp -u); ./$prog --serve \$sock & \
+        while [ ! -S \$sock ]; do sleep 0.1; done; \
+        printf 'new a 3,5\ndraw a -h 7\ndraw b -h 1\nload c\n.x\n\nfoo\nprint a\n' | ./$prog --client \$sock; \
+        kill \$!; wait"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "OK 3,5" ]
+    [ "${lines[1]}" = "ERR 7 incorrect value with option -h" ]
+    [ "${lines[2]}" = "ERR 7 unknown canvas b" ]
+    [ "${lines[3]}" = "ERR 1 wrong pixel value x" ]
+    [ "${lines[4]}" = "ERR 5 unrecognized option foo" ]
+    [ "${lines[5]}" = "OK 3,5" ]
+}
+
+@test "A refused draw request leaves the resident canvas unchanged" {
+    run bash -c "sock=\$(mktemp -u); ./$prog --serve \$sock & \
+        while [ ! -S \$sock ]; do sleep 0.1; done; \
+        printf 'new a 3,5\ndraw a -h 1 -p 2 -v 9\ndraw a -h 0\nprint a\n' | ./$prog --client \$sock; \
+        kill \$!; wait"
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "OK 3,5" ]
+    [ "${lines[1]}" = "ERR 7 incorrect value with option -v" ]
+    [ "${lines[2]}" = "OK 1" ]
+    [ "${lines[3]}" = "OK 3,5" ]
+    [ "${lines[4]}" = "77777" ]
+    [ "${lines[5]}" = "....." ]
+    [ "${lines[6]}" = "....." ]
+}
+
 @test "Drawing non diagonal segment" {
     run ./$prog -n 5,10 -l 1,1,3,8
     [ "$status" -eq 0 ]
@@ -139,11 +447,28 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "${lines[4]}" = "7...." ]
 }
 
+@test "Clipping shapes reaching far outside the canvas" {
+    run ./$prog -n 5,8 -l -1000000000,-999999999,1000000003,1000000004 -c 2,-1000000,1000003
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = ".7.7...." ]
+    [ "${lines[1]}" = "..77...." ]
+    [ "${lines[2]}" = "...7...." ]
+    [ "${lines[3]}" = "...77..." ]
+    [ "${lines[4]}" = "...7.7.." ]
+}
+
 @test "Option -k is recognized" {
     run ./$prog -n 19,19 -p 1 -c 9,9,9 -l 3,3,15,15 -l 3,15,15,3 -k
     [ "$status" -eq 0 ]
 }
 
+@test "Option -k emits one escape sequence per run of color" {
+    run ./$prog -n 2,6 -p 1 -r 0,1,2,3 -k
+    [ "$status" -eq 0 ]
+    [ "${lines[0]}" = "$(printf ' \033[41m   \033[0m  ')" ]
+    [ "${lines[1]}" = "$(printf ' \033[41m   \033[0m  ')" ]
+}
+
 # Handling errors
 
 @test "Forbidding character # in canvas" {
@@ -153,6 +478,12 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "${lines[1]}" = "$help_first_line" ]
 }
 
+@test "Wrong pixel on a last line without newline" {
+    run bash -c "printf '....\n..7.\n.a..' | ./$prog -s"
+    [ "$status" -eq 1 ]
+    [ "${lines[0]}" = "Error: wrong pixel value a" ]
+}
+
 @test "Canvas of 41 lines is too high" {
     run ./$prog -s < $examples_folder/too-high.canvas
     [ "$status" -eq 2 ]
@@ -223,6 +554,12 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "${lines[1]}" = "$help_first_line" ]
 }
 
+@test "Unrecognized command in a script" {
+    run bash -c "printf 'z 1\n' | ./$prog -n 3,3 -f -"
+    [ "$status" -eq 5 ]
+    [ "${lines[0]}" = "Error: unrecognized option z" ]
+}
+
 # Negative values
 
 @test "Negative value with option -h is forbidden" {
@@ -266,6 +603,18 @@ help_first_line="Usage: ./canvascii [-n HEIGHT,WIDTH] [-s] [-k] [-p CHAR]"
     [ "${lines[4]}" = "....7" ]
 }
 
+@test "Segment ends more than INT_MAX apart are forbidden" {
+    run ./$prog -n 5,5 -l 0,0,2147483647,2147483647
+    [ "$status" -eq 0 ]
+    [ "${lines[4]}" = "....7" ]
+    run ./$prog -n 5,5 -l -2147483648,-2147483648,2147483647,2147483647
+    [ "$status" -eq 7 ]
+    [ "${lines[0]}" = "Error: incorrect value with option -l" ]
+    run ./$prog -n 5,5 -P 0,0,4,4,-2147483648,0
+    [ "$status" -eq 7 ]
+    [ "${lines[0]}" = "Error: incorrect value with option -P" ]
+}
+
 @test "Negative positions with option -c are allowed" {
     run ./$prog -n 5,5 -c -1,-1,5
     [ "$status" -eq 0 ]
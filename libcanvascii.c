@@ -0,0 +1,4480 @@
+/**
+ * Projet Canvascii - Bibliothèque de dessin sur un canevas ASCII
+ *
+ * Ce fichier, libcanvascii.c, contient le moteur de canvascii : stockage
+ * des pixels (par rangées, par tuiles ou compact), lecture des canevas
+ * texte, RLE et binaires, routines de tracé et impression. Aucune de ses
+ * fonctions n'affiche de message ni ne termine le programme : les erreurs
+ * sont retournées sous forme de enum error, et la ligne de commande
+ * (canvascii.c) se charge de les signaler. L'interface publique, décrite
+ * dans canvascii.h, manipule les canevas par pointeur.
+ *
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "canvascii_interne.h"
+
+#define ALIGNEMENT_PIXELS 64 // Alignement (en octets) du tampon et du pas des rangées
+#define CAPACITE_INITIALE_RANGEES 64
+#define COULEUR_DEFAUT -1                // Couleur du terminal après "\033[0m"
+#define SEUIL_MEMSET 16                   // Longueur de plage à partir de laquelle on passe par memset
+#define COTE_TUILE 64                     // Côté (en pixels) d'une tuile de la disposition --tiled
+#define TAILLE_TUILE (COTE_TUILE * COTE_TUILE) // Octets par tuile, soit une page mémoire
+#define OCTET_VIDE_COMPACT 0xEE           // Deux pixels '.' en disposition compacte (--packed)
+#define TAILLE_TRANCHE_SORTIE (1024 * 1024) // Octets formatés par thread et par tour avec -j
+#define MAGIE_BINAIRE "CANVASCI"          // Signature des canevas binaires (-i, -o)
+#define VERSION_BINAIRE 1                 // Version du format binaire
+#define MAGIE_PROGRAMME "CANVPROG"        // Signature des programmes compilés (--compile, --run)
+#define VERSION_PROGRAMME 4               // Version du format des programmes
+#define INSTRUCTIONS_PAR_LECTURE 4096     // Instructions lues à la fois par charger_programme
+#define CAPACITE_INITIALE_GERMES 256      // Plages en attente allouées au départ d'un remplissage
+
+typedef struct {
+    char magie[8];          // MAGIE_BINAIRE, sans zéro final
+    uint32_t version;       // VERSION_BINAIRE
+    uint32_t height;        // Nombre de rangées
+    uint32_t width;         // Nombre de colonnes
+    uint32_t disposition;   // DISPOSITION_TUILES et DISPOSITION_COMPACTE combinées
+    uint64_t stride;        // Octets entre deux rangées, ou deux rangées de tuiles
+    uint64_t decalage;      // Position des pixels dans le fichier
+    char reserve[24];       // Zéros, pour une en-tête de ALIGNEMENT_PIXELS octets
+} EnteteBinaire;
+
+_Static_assert(sizeof(EnteteBinaire) == ALIGNEMENT_PIXELS, "en-tête binaire de 64 octets");
+
+typedef struct {
+    char magie[8];          // MAGIE_PROGRAMME, sans zéro final
+    uint32_t version;       // VERSION_PROGRAMME
+    uint32_t reserve;       // Zéro
+    uint64_t nombre;        // Nombre d'instructions qui suivent
+} EnteteProgramme;
+
+typedef struct {
+    int32_t valeurs[4];     // Paramètres, dans l'ordre de la ligne de commande
+    uint8_t type;           // enum type_commande, de COMMANDE_CRAYON à COMMANDE_AFFICHAGE
+    char crayon;            // Crayon de -p
+    uint8_t reserve[2];     // Zéros
+} Instruction;
+
+_Static_assert(sizeof(Instruction) == 20, "instruction de 20 octets");
+
+typedef struct {
+    struct canvas canvas;       // Mêmes pixels que le canevas, crayon propre à la bande
+    Fenetre fenetre;            // Rangées attribuées au thread
+    const Commande *commandes;  // Commandes rejouées dans l'ordre
+    size_t nombre;              // Nombre de commandes
+    enum error erreur;          // Première erreur de tracé, qui arrête la bande
+    size_t fautive;             // Indice de la commande en erreur
+    CompteurTrace compteurs[COMMANDE_SCRIPT]; // Compteurs propres à la bande (--stats)
+} Bande;
+
+typedef struct {
+    long rangee;            // Rangée à examiner
+    long colonne_debut;     // Première colonne de la plage d'origine (incluse)
+    long colonne_fin;       // Dernière colonne de la plage d'origine (incluse)
+    int sens;               // 1 si la plage d'origine est au-dessus, -1 si elle est en dessous
+} PlageGerme;
+
+typedef struct {
+    PlageGerme *plages;     // Plages en attente, la dernière au sommet
+    size_t nombre;          // Nombre de plages en attente
+    size_t capacite;        // Nombre de plages allouées
+} PileGermes;
+
+typedef struct {
+    long long rangee_debut;         // Rangée du sommet du haut, première coupée (incluse)
+    long long rangee_fin;           // Rangée du sommet du bas (exclue)
+    long long colonne;              // Partie entière de la colonne coupée à la rangée courante
+    unsigned long long reste;       // Partie fractionnaire de cette colonne, en hauteur-ièmes
+    unsigned long long hauteur;     // Nombre de rangées couvertes, non nul
+    long long pas;                  // Partie entière de la pente, en colonnes par rangée
+    unsigned long long pas_reste;   // Partie fractionnaire de la pente, en hauteur-ièmes
+} AretePolygone;
+
+typedef struct {
+    const struct canvas *canvas;    // Canevas à formater
+    int couleur;                    // Encodage en couleurs ANSI (-k)
+    unsigned int rangee_debut;      // Première rangée de la tranche (incluse)
+    unsigned int rangee_fin;        // Dernière rangée de la tranche (exclue)
+    char *zone;                     // Octets formatés, privés au thread
+    size_t capacite;                // Capacité de la zone, assez grande pour la tranche
+    size_t taille;                  // Nombre d'octets formatés
+    char *tampon;                   // Tampon de lire_rangee propre au thread
+} TrancheSortie;
+
+/**
+ * est_numerique - Détermine si une chaîne de caractères représente un nombre entier valide.
+ *
+ * Cette fonction vérifie si une chaîne donnée est composée uniquement de chiffres,
+ * avec une gestion optionnelle d'un signe négatif au début. La fonction retourne 1
+ * si la chaîne est numérique, sinon 0.
+ *
+ * Une chaîne NULL ou vide, ou composée uniquement d'un signe moins,
+ * est considérée comme non numérique.
+ *
+ * @param chaine_de_caractere Pointeur vers la chaîne de caractères à évaluer.
+ * @return int 1 si la chaîne est numérique, 0 sinon.
+ */
+int est_numerique(const char *chaine_de_caractere) {
+    if (chaine_de_caractere == NULL || *chaine_de_caractere == '\0') {
+        return 0;  // Retourne 0 si la chaîne est NULL ou vide
+    }
+
+    // Gère le signe moins au début de la chaîne
+    if (*chaine_de_caractere == '-') {
+        chaine_de_caractere++;     
+    }
+
+    // Si la chaîne était seulement "-", ce n'est pas un nombre
+    if (*chaine_de_caractere == '\0') {
+        return 0;
+    }
+
+    // Vérifie que tous les caractères restants sont des chiffres
+    while (*chaine_de_caractere != '\0') {
+        if (!isdigit((unsigned char)*chaine_de_caractere)) {
+            return 0;
+        }
+        chaine_de_caractere++;
+    }
+
+    return 1;  // Tous les caractères sont numériques, donc c'est un nombre valide (éventuellement négatif)
+}
+
+/**
+ * convertir_entier - Convertit une chaîne en entier si elle est numérique.
+ *
+ * @param valeur Chaîne à évaluer et convertir.
+ * @param resultat Pointeur vers l'entier converti.
+ * @return enum error OK, ou ERR_WITH_VALUE si la chaîne n'est pas numérique.
+ */
+enum error convertir_entier(const char *valeur, int *resultat) {
+    if (!est_numerique(valeur)) return ERR_WITH_VALUE;
+    *resultat = atoi(valeur);
+    return OK;
+}
+
+/**
+ * est_negatif - Détermine si un nombre entier est négatif.
+ *
+ * Retourne 1 si le nombre est négatif ou zéro, et 0 si le nombre est positif.
+ *
+ * @param nombre Le nombre entier à vérifier.
+ * @return int 1 si le nombre est négatif ou zéro, sinon 0.
+ */
+int est_negatif(int nombre) {
+    if (nombre > 0) return 0;
+    return 1;
+
+}
+
+/**
+ * verifier_dimensions - Vérifie si les dimensions du canevas sont dans
+ * les limites permises, sans terminer le programme.
+ *
+ * Si le canevas est limité, la longueur ne peut dépasser MAX_HEIGHT ni la
+ * largeur MAX_WIDTH. Sinon (option -u, ou canevas de la bibliothèque),
+ * seule la mémoire disponible limite les dimensions.
+ *
+ * @param canvas Pointeur vers le canevas dont limitee est fixé.
+ * @param longueur Longueur du canevas à vérifier.
+ * @param largeur Largeur du canevas à vérifier.
+ * @return enum error OK, ERR_CANVAS_TOO_HIGH ou ERR_CANVAS_TOO_WIDE.
+ */
+enum error verifier_dimensions(const struct canvas *canvas, unsigned int longueur, unsigned int largeur) {
+    if (!canvas->limitee) return OK;
+
+    if (longueur > MAX_HEIGHT) return ERR_CANVAS_TOO_HIGH;
+    if (largeur > MAX_WIDTH) return ERR_CANVAS_TOO_WIDE;
+    return OK;
+}
+
+/**
+ * calculer_pas_rangee - Calcule le pas (stride) d'une rangée de pixels.
+ *
+ * Arrondit la largeur au multiple de ALIGNEMENT_PIXELS supérieur afin que
+ * chaque rangée débute sur une adresse alignée.
+ *
+ * @param largeur Largeur du canevas en pixels.
+ * @return size_t Nombre d'octets séparant deux rangées consécutives.
+ */
+size_t calculer_pas_rangee(unsigned int largeur) {
+    size_t pas = ((size_t) largeur + ALIGNEMENT_PIXELS - 1) / ALIGNEMENT_PIXELS;
+    return pas * ALIGNEMENT_PIXELS;
+}
+
+/**
+ * allouer_pixels - Alloue un tampon de pixels contigu et aligné.
+ *
+ * Réserve la mémoire pour un nombre de rangées donné avec le pas spécifié.
+ *
+ * @param nombre_rangees Nombre de rangées à réserver.
+ * @param pas Nombre d'octets par rangée (multiple de l'alignement).
+ * @param alignement Alignement du tampon : ALIGNEMENT_PIXELS, ou
+ * TAILLE_TUILE pour que chaque tuile occupe exactement une page.
+ * @return char* Tampon aligné, ou NULL si la taille déborde ou si
+ * l'allocation échoue.
+ */
+char *allouer_pixels(size_t nombre_rangees, size_t pas, size_t alignement) {
+    size_t taille = nombre_rangees * pas;
+
+    if (pas != 0 && taille / pas != nombre_rangees) return NULL;
+    if (taille == 0) taille = alignement; // aligned_alloc refuse une taille nulle
+
+    return aligned_alloc(alignement, taille);
+}
+
+/**
+ * liberer_canvas - Libère le tampon de pixels d'un canevas.
+ *
+ * @param canvas Pointeur vers le canevas à libérer.
+ */
+void liberer_canvas(struct canvas *canvas) {
+    if (canvas->projection != NULL) munmap(canvas->projection, canvas->taille_projection);
+    else free(canvas->pixels);
+    free(canvas->modifs);
+    if (canvas->rle != NULL) {
+        free(canvas->rle->donnees);
+        free(canvas->rle->debuts);
+        free(canvas->rle->decodee);
+        free(canvas->rle);
+    }
+    free(canvas->rangee_lue);
+    canvas->pixels = NULL;
+    canvas->modifs = NULL;
+    canvas->rangee_lue = NULL;
+    canvas->rle = NULL;
+    canvas->projection = NULL;
+    canvas->taille_projection = 0;
+    canvas->stride = 0;
+}
+
+/**
+ * rangee_canvas - Retourne l'adresse du premier pixel d'une rangée.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Indice de la rangée (doit être inférieur à la hauteur).
+ * @return char* Adresse du pixel (rangee, 0).
+ */
+char *rangee_canvas(const struct canvas *canvas, unsigned int rangee) {
+    return canvas->pixels + (size_t) rangee * canvas->stride;
+}
+
+/**
+ * coder_pixel - Retourne le code sur 4 bits d'un pixel valide.
+ *
+ * Les couleurs '0' à '7' deviennent 0 à 7 et '.' devient 0xE : une
+ * soustraction et un masque suffisent, ce qui se vectorise directement.
+ *
+ * @param pixel Caractère d'un pixel valide.
+ * @return unsigned char Code du pixel, entre 0 et 15.
+ */
+unsigned char coder_pixel(char pixel) {
+    return (unsigned char) (pixel - '0') & 0x0F;
+}
+
+/**
+ * emballer_pixels - Compacte des pixels ASCII valides à raison de deux par octet.
+ *
+ * Le pixel de rang pair occupe les 4 bits de poids faible. Avec SSE2, 32
+ * pixels sont compactés à la fois : chaque paire, vue comme un entier de
+ * 16 bits, est réduite à un octet avant la saturation finale.
+ *
+ * @param destination Tampon d'au moins (nombre + 1) / 2 octets.
+ * @param pixels Pixels ASCII, déjà validés.
+ * @param nombre Nombre de pixels.
+ */
+void emballer_pixels(char *destination, const char *pixels, size_t nombre) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i quartet = _mm_set1_epi8(0x0F);
+    const __m128i bas = _mm_set1_epi16(0x000F);
+    const __m128i haut = _mm_set1_epi16(0x00F0);
+
+    for (; i + 32 <= nombre; i += 32) {
+        __m128i a = _mm_and_si128(_mm_sub_epi8(_mm_loadu_si128((const __m128i *) (pixels + i)), zero), quartet);
+        __m128i b = _mm_and_si128(_mm_sub_epi8(_mm_loadu_si128((const __m128i *) (pixels + i + 16)), zero), quartet);
+        a = _mm_or_si128(_mm_and_si128(a, bas), _mm_and_si128(_mm_srli_epi16(a, 4), haut));
+        b = _mm_or_si128(_mm_and_si128(b, bas), _mm_and_si128(_mm_srli_epi16(b, 4), haut));
+        _mm_storeu_si128((__m128i *) (destination + i / 2), _mm_packus_epi16(a, b));
+    }
+#endif
+    for (; i + 1 < nombre; i += 2) {
+        destination[i / 2] = (char) (coder_pixel(pixels[i]) | coder_pixel(pixels[i + 1]) << 4);
+    }
+    if (i < nombre) destination[i / 2] = (char) (coder_pixel(pixels[i]) | 0xE0);
+}
+
+/**
+ * deballer_pixels - Restitue des pixels ASCII à partir de leurs codes sur 4 bits.
+ *
+ * Avec SSE2, 16 octets donnent 32 pixels : les quartets sont séparés,
+ * entrelacés, puis convertis en ajoutant '0', sauf le code 0xE qui
+ * redevient '.'.
+ *
+ * @param destination Tampon d'au moins nombre octets.
+ * @param octets Pixels compactés.
+ * @param nombre Nombre de pixels à restituer.
+ */
+void deballer_pixels(char *destination, const char *octets, size_t nombre) {
+    static const char CARACTERES[16] = "01234567??????.?";
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i quartet = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i vide = _mm_set1_epi8(0x0E);
+    const __m128i ecart_point = _mm_set1_epi8('0' + 0x0E - '.');
+
+    for (; i + 32 <= nombre; i += 32) {
+        __m128i bloc = _mm_loadu_si128((const __m128i *) (octets + i / 2));
+        __m128i bas = _mm_and_si128(bloc, quartet);
+        __m128i haut = _mm_and_si128(_mm_srli_epi16(bloc, 4), quartet);
+        __m128i codes[2] = {_mm_unpacklo_epi8(bas, haut), _mm_unpackhi_epi8(bas, haut)};
+
+        for (int k = 0; k < 2; k++) {
+            __m128i correction = _mm_and_si128(_mm_cmpeq_epi8(codes[k], vide), ecart_point);
+            __m128i caracteres = _mm_sub_epi8(_mm_add_epi8(codes[k], zero), correction);
+            _mm_storeu_si128((__m128i *) (destination + i + 16 * k), caracteres);
+        }
+    }
+#endif
+    for (; i < nombre; i++) {
+        unsigned char octet = (unsigned char) octets[i / 2];
+        destination[i] = CARACTERES[i % 2 == 0 ? octet & 0x0F : octet >> 4];
+    }
+}
+
+/**
+ * pixel_canvas - Retourne l'adresse d'un pixel, quelle que soit la disposition.
+ *
+ * Par défaut, les pixels sont rangés par rangées et ceux d'une rangée sont
+ * contigus. En disposition par tuiles, le canevas est découpé en tuiles de
+ * COTE_TUILE x COTE_TUILE pixels, stockées l'une après l'autre et rangées
+ * elles-mêmes par rangées; stride est alors l'écart entre deux rangées de
+ * tuiles. Une colonne ne change ainsi de page qu'une fois toutes les
+ * COTE_TUILE rangées. En disposition compacte, deux pixels voisins
+ * partagent un octet et toutes les largeurs en octets sont divisées par 2.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du pixel, comprise dans le canevas.
+ * @param colonne Colonne du pixel, comprise dans le canevas.
+ * @return char* Adresse de l'octet contenant le pixel.
+ */
+char *pixel_canvas(const struct canvas *canvas, size_t rangee, size_t colonne) {
+    int compacte = canvas->packed;
+
+    if (!canvas->tiled) return canvas->pixels + rangee * canvas->stride + (colonne >> compacte);
+
+    return canvas->pixels + rangee / COTE_TUILE * canvas->stride
+           + colonne / COTE_TUILE * (TAILLE_TUILE >> compacte)
+           + rangee % COTE_TUILE * (COTE_TUILE >> compacte) + (colonne % COTE_TUILE >> compacte);
+}
+
+/**
+ * marquer_modification - Ajoute une plage de colonnes aux modifications d'une rangée.
+ *
+ * Les modifications d'une rangée sont conservées sous la forme de la plus
+ * petite plage de colonnes qui les contient toutes.
+ *
+ * @param canvas Pointeur vers un canevas dont les modifications sont suivies.
+ * @param rangee Rangée modifiée.
+ * @param colonne_debut Première colonne modifiée (incluse).
+ * @param colonne_fin Dernière colonne modifiée (exclue).
+ */
+void marquer_modification(struct canvas *canvas, long rangee, long colonne_debut, long colonne_fin) {
+    PlageModifiee *plage = &canvas->modifs[rangee];
+
+    if (plage->debut == plage->fin) {
+        plage->debut = colonne_debut;
+        plage->fin = colonne_fin;
+        return;
+    }
+    if (colonne_debut < plage->debut) plage->debut = colonne_debut;
+    if (colonne_fin > plage->fin) plage->fin = colonne_fin;
+}
+
+/**
+ * placer_pixel_disposition - Écrit le crayon sur un pixel d'un canevas par tuiles, compact
+ * ou dont les modifications sont suivies.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du pixel, comprise dans le canevas.
+ * @param colonne Colonne du pixel, comprise dans le canevas.
+ */
+void placer_pixel_disposition(struct canvas *canvas, size_t rangee, size_t colonne) {
+    char *octet = pixel_canvas(canvas, rangee, colonne);
+
+    if (canvas->modifs != NULL) marquer_modification(canvas, rangee, colonne, colonne + 1);
+    if (!canvas->packed) {
+        *octet = canvas->pen;
+    } else {
+        int decalage = (colonne % 2) * 4;
+        *octet = (char) ((*octet & ~(0x0F << decalage)) | coder_pixel(canvas->pen) << decalage);
+    }
+}
+
+/**
+ * placer_pixel - Écrit le crayon sur un pixel, quelle que soit la disposition.
+ *
+ * La disposition ordinaire est traitée directement, pour que cette
+ * fonction reste assez courte pour être intégrée aux boucles de tracé.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du pixel, comprise dans le canevas.
+ * @param colonne Colonne du pixel, comprise dans le canevas.
+ */
+void placer_pixel(struct canvas *canvas, size_t rangee, size_t colonne) {
+    if (canvas->tiled || canvas->packed || canvas->modifs != NULL) {
+        placer_pixel_disposition(canvas, rangee, colonne);
+        return;
+    }
+    canvas->pixels[rangee * canvas->stride + colonne] = canvas->pen;
+}
+
+/**
+ * lire_pixel - Retourne un pixel, quelle que soit la disposition.
+ *
+ * @param canvas Pointeur vers le canevas, dont la rangée est décodée.
+ * @param rangee Rangée du pixel, comprise dans le canevas.
+ * @param colonne Colonne du pixel, comprise dans le canevas.
+ * @return char Pixel, '.' ou de '0' à '7'.
+ */
+char lire_pixel(const struct canvas *canvas, size_t rangee, size_t colonne) {
+    if (!canvas->tiled && !canvas->packed) return canvas->pixels[rangee * canvas->stride + colonne];
+
+    unsigned char octet = (unsigned char) *pixel_canvas(canvas, rangee, colonne);
+    if (!canvas->packed) return (char) octet;
+
+    unsigned char code = colonne % 2 == 0 ? octet & 0x0F : octet >> 4;
+    return code == 0x0E ? '.' : (char) ('0' + code);
+}
+
+/**
+ * octets_par_rangee - Retourne le nombre d'octets utiles d'une rangée de pixels.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @return size_t width, ou sa moitié arrondie vers le haut en disposition compacte.
+ */
+size_t octets_par_rangee(const struct canvas *canvas) {
+    return canvas->packed ? ((size_t) canvas->width + 1) / 2 : canvas->width;
+}
+
+/**
+ * nombre_rangees_stockees - Retourne le nombre de pas de stride du tampon.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @return size_t Nombre de rangées de pixels, ou de rangées de tuiles.
+ */
+size_t nombre_rangees_stockees(const struct canvas *canvas) {
+    if (!canvas->tiled) return canvas->height;
+    return ((size_t) canvas->height + COTE_TUILE - 1) / COTE_TUILE;
+}
+
+/**
+ * lire_rangee - Retourne les pixels d'une rangée sous forme contiguë.
+ *
+ * En disposition par rangées, la rangée est lue en place. En disposition
+ * par tuiles, ses morceaux sont copiés tuile par tuile dans le tampon; en
+ * disposition compacte, ils y sont décompactés.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Indice de la rangée.
+ * @param tampon Tampon d'au moins width octets, inutilisé en disposition
+ * ordinaire.
+ * @return const char* Adresse des width pixels de la rangée.
+ */
+const char *lire_rangee(const struct canvas *canvas, unsigned int rangee, char *tampon) {
+    if (!canvas->tiled && !canvas->packed) return rangee_canvas(canvas, rangee);
+
+    unsigned int morceau = canvas->tiled ? COTE_TUILE : canvas->width;
+    for (unsigned int colonne = 0; colonne < canvas->width; colonne += morceau) {
+        unsigned int longueur = canvas->width - colonne < morceau ? canvas->width - colonne : morceau;
+        const char *octets = pixel_canvas(canvas, rangee, colonne);
+
+        if (canvas->packed) deballer_pixels(tampon + colonne, octets, longueur);
+        else memcpy(tampon + colonne, octets, longueur);
+    }
+    return tampon;
+}
+
+/**
+ * calculer_pas_canvas - Calcule le pas d'un canevas selon sa disposition.
+ *
+ * @param canvas Pointeur vers le canevas dont width, tiled et packed sont fixés.
+ * @return size_t Octets entre deux rangées, ou entre deux rangées de tuiles.
+ */
+size_t calculer_pas_canvas(const struct canvas *canvas) {
+    if (!canvas->tiled) return calculer_pas_rangee(octets_par_rangee(canvas));
+    return ((size_t) canvas->width + COTE_TUILE - 1) / COTE_TUILE * (TAILLE_TUILE >> canvas->packed);
+}
+
+/**
+ * alignement_pixels - Retourne l'alignement des pixels d'un canevas selon sa disposition.
+ *
+ * @param canvas Pointeur vers le canevas dont tiled et packed sont fixés.
+ * @return size_t Taille d'une tuile par tuiles, ALIGNEMENT_PIXELS sinon.
+ */
+size_t alignement_pixels(const struct canvas *canvas) {
+    return canvas->tiled ? (size_t) TAILLE_TUILE >> canvas->packed : ALIGNEMENT_PIXELS;
+}
+
+/**
+ * allouer_rangee_lue - Alloue le tampon de rangée utilisé par lire_rangee.
+ *
+ * Seules les dispositions par tuiles et compacte en ont besoin; le tampon
+ * est alloué une fois pour toutes, afin que l'impression n'alloue rien.
+ *
+ * @param canvas Pointeur vers le canevas dont width, tiled et packed sont fixés.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY.
+ */
+enum error allouer_rangee_lue(struct canvas *canvas) {
+    if ((!canvas->tiled && !canvas->packed) || canvas->rangee_lue != NULL) return OK;
+
+    canvas->rangee_lue = malloc((size_t) canvas->width + 1);
+    return canvas->rangee_lue == NULL ? ERR_OUT_OF_MEMORY : OK;
+}
+
+/**
+ * allouer_canvas - Alloue et vide un canevas aux dimensions déjà fixées.
+ *
+ * Vérifie les dimensions, alloue le tampon de pixels et le remplit avec
+ * le caractère '.', sans jamais terminer le programme.
+ *
+ * @param canvas Pointeur vers le canevas dont height, width, tiled et packed sont fixés.
+ * @return enum error OK, ERR_CANVAS_TOO_HIGH, ERR_CANVAS_TOO_WIDE ou ERR_OUT_OF_MEMORY.
+ */
+enum error allouer_canvas(struct canvas *canvas) {
+    enum error erreur = verifier_dimensions(canvas, canvas->height, canvas->width);
+    if (erreur != OK) return erreur;
+
+    canvas->stride = calculer_pas_canvas(canvas);
+    canvas->pixels = allouer_pixels(nombre_rangees_stockees(canvas), canvas->stride,
+                                    alignement_pixels(canvas));
+    if (canvas->pixels == NULL) return ERR_OUT_OF_MEMORY;
+    memset(canvas->pixels, canvas->packed ? OCTET_VIDE_COMPACT : '.',
+           nombre_rangees_stockees(canvas) * canvas->stride);
+    erreur = allouer_rangee_lue(canvas);
+    if (erreur != OK) {
+        free(canvas->pixels);
+        canvas->pixels = NULL;
+    }
+    return erreur;
+}
+
+/**
+ * disposer_en_tuiles - Convertit un canevas rangé par rangées en tuiles.
+ *
+ * Le chargement depuis stdin produit toujours un canevas par rangées,
+ * puisque sa hauteur n'est connue qu'à la fin; il est converti ensuite
+ * en une seule passe.
+ *
+ * @param canvas Pointeur vers le canevas, rangé par rangées, compact ou non.
+ * @return enum error OK ou ERR_OUT_OF_MEMORY, auquel cas le canevas est intact.
+ */
+enum error disposer_en_tuiles(struct canvas *canvas) {
+    struct canvas tuiles = *canvas;
+    tuiles.tiled = 1;
+    tuiles.projection = NULL;
+    tuiles.taille_projection = 0;
+
+    enum error erreur = allouer_canvas(&tuiles);
+    if (erreur != OK) return erreur;
+
+    for (unsigned int rangee = 0; rangee < canvas->height; rangee++) {
+        for (unsigned int colonne = 0; colonne < canvas->width; colonne += COTE_TUILE) {
+            unsigned int longueur = canvas->width - colonne < COTE_TUILE ? canvas->width - colonne : COTE_TUILE;
+            if (canvas->packed) longueur = (longueur + 1) / 2;
+            memcpy(pixel_canvas(&tuiles, rangee, colonne), pixel_canvas(canvas, rangee, colonne), longueur);
+        }
+    }
+    canvas->modifs = NULL;     // Conservés par tuiles, dont les rangées RLE
+    canvas->rle = NULL;        // encore vides ('.') seront décodées plus tard
+    canvas->rangee_lue = NULL;
+    liberer_canvas(canvas);
+    *canvas = tuiles;
+    return OK;
+}
+
+/**
+ * creer_canvas - Initialise un canevas avec une couleur spécifiée.
+ *
+ * Vérifie les dimensions du canevas et alloue son tampon de pixels.
+ * Si aucune couleur n'est spécifiée, utilise '7' par défaut.
+ * Remplit le canevas avec le caractère '.'. Le canevas est initialisé
+ * en place, sans copie.
+ *
+ * @param canvas Pointeur vers le canevas à initialiser.
+ * @param couleur Couleur du stylo, '7' si non spécifiée.
+ * @return enum error OK, ERR_CANVAS_TOO_HIGH, ERR_CANVAS_TOO_WIDE ou ERR_OUT_OF_MEMORY.
+ */
+enum error creer_canvas(struct canvas *canvas, char couleur) {
+    if (couleur == '\0') couleur =  '7';
+    canvas->pen = couleur;
+    return allouer_canvas(canvas);
+}
+
+/**
+ * est_valeur_absente - Vérifie si une valeur fournie est nulle ou vide.
+ *
+ * @param valeur Chaîne de caractères représentant la valeur à vérifier.
+ * @return int 1 si la valeur est absente, 0 sinon.
+ */
+int est_valeur_absente(const char *valeur) {
+    return valeur == NULL || *valeur == '\0';
+}
+
+/**
+ * initialiser_tampon_sortie - Prépare un tampon de sortie vers un flux.
+ *
+ * @param sortie Pointeur vers le tampon à initialiser.
+ * @param zone Zone mémoire servant au formatage.
+ * @param capacite Taille de la zone en octets.
+ * @param flux Flux de destination des octets.
+ */
+void initialiser_tampon_sortie(TamponSortie *sortie, char *zone, size_t capacite, FILE *flux) {
+    sortie->donnees = zone;
+    sortie->taille = 0;
+    sortie->capacite = capacite;
+    sortie->flux = flux;
+    sortie->octets_ecrits = 0;
+}
+
+/**
+ * vider_tampon_sortie - Transmet au flux les octets en attente.
+ *
+ * Écrit le contenu de la zone en un seul appel à fwrite et
+ * comptabilise les octets écrits.
+ *
+ * @param sortie Pointeur vers le tampon à vider.
+ */
+void vider_tampon_sortie(TamponSortie *sortie) {
+    if (sortie->taille == 0) return;
+    sortie->octets_ecrits += fwrite(sortie->donnees, 1, sortie->taille, sortie->flux);
+    sortie->taille = 0;
+}
+
+/**
+ * ajouter_octets - Ajoute une suite d'octets au tampon de sortie.
+ *
+ * Vide la zone lorsqu'elle est pleine. Une suite plus grande que la zone
+ * est transmise directement au flux, sans copie intermédiaire.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param octets Octets à ajouter.
+ * @param nombre Nombre d'octets à ajouter.
+ */
+void ajouter_octets(TamponSortie *sortie, const char *octets, size_t nombre) {
+    if (sortie->taille + nombre > sortie->capacite) {
+        vider_tampon_sortie(sortie);
+        if (nombre >= sortie->capacite) {
+            sortie->octets_ecrits += fwrite(octets, 1, nombre, sortie->flux);
+            return;
+        }
+    }
+    memcpy(sortie->donnees + sortie->taille, octets, nombre);
+    sortie->taille += nombre;
+}
+
+/**
+ * ajouter_octet - Ajoute un seul octet au tampon de sortie.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param octet Octet à ajouter.
+ */
+void ajouter_octet(TamponSortie *sortie, char octet) {
+    if (sortie->taille == sortie->capacite) vider_tampon_sortie(sortie);
+    sortie->donnees[sortie->taille++] = octet;
+}
+
+/**
+ * ajouter_repetition - Ajoute plusieurs fois le même octet au tampon de sortie.
+ *
+ * Remplit la zone par blocs avec memset, en la vidant au besoin.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param octet Octet à répéter.
+ * @param nombre Nombre de répétitions.
+ */
+void ajouter_repetition(TamponSortie *sortie, char octet, size_t nombre) {
+    while (nombre > 0) {
+        if (sortie->taille == sortie->capacite) vider_tampon_sortie(sortie);
+
+        size_t bloc = sortie->capacite - sortie->taille;
+        if (bloc > nombre) bloc = nombre;
+        memset(sortie->donnees + sortie->taille, octet, bloc);
+        sortie->taille += bloc;
+        nombre -= bloc;
+    }
+}
+
+/**
+ * ecrire_canvas - Formate un canevas dans un tampon de sortie.
+ *
+ * Copie chaque rangée suivie d'un retour à la ligne dans le tampon,
+ * qui n'est transmis au flux que lorsqu'il est plein.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param canvas Pointeur vers le canevas à formater.
+ */
+void ecrire_canvas(TamponSortie *sortie, const struct canvas *canvas) {
+    for (unsigned int i = 0; i < canvas->height; i++) {
+        ajouter_octets(sortie, lire_rangee(canvas, i, canvas->rangee_lue), canvas->width);
+        ajouter_octet(sortie, '\n');
+    }
+}
+
+/**
+ * imprimer_canvas - Affiche un canevas sur un flux.
+ *
+ * Formate les rangées du canevas, chacune suivie par un retour à la
+ * ligne, dans un tampon transmis au flux par gros blocs.
+ *
+ * @param canvas Pointeur vers le canevas à imprimer.
+ * @param flux Flux de destination, stdout pour la ligne de commande.
+ * @return size_t Nombre d'octets écrits sur le flux.
+ */
+size_t imprimer_canvas(struct canvas *canvas, FILE *flux) {
+    char zone[TAILLE_TAMPON_SORTIE];
+    TamponSortie sortie;
+
+    initialiser_tampon_sortie(&sortie, zone, sizeof(zone), flux);
+    ecrire_canvas(&sortie, canvas);
+    vider_tampon_sortie(&sortie);
+    return sortie.octets_ecrits;
+}
+
+/**
+ * ecrire_rangee_rle - Formate une rangée en plages de pixels identiques.
+ *
+ * Chaque plage est écrite comme son pixel, précédé de sa répétition si
+ * elle dépasse 1, et les plages sont séparées par une espace.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param rangee Pixels de la rangée, en ASCII.
+ * @param largeur Nombre de pixels de la rangée.
+ */
+void ecrire_rangee_rle(TamponSortie *sortie, const char *rangee, unsigned int largeur) {
+    unsigned int debut = 0;
+
+    while (debut < largeur) {
+        unsigned int fin = debut + 1;
+        char nombre[16];
+
+        while (fin < largeur && rangee[fin] == rangee[debut]) fin++;
+        if (debut > 0) ajouter_octet(sortie, ' ');
+        if (fin - debut > 1) ajouter_octets(sortie, nombre, snprintf(nombre, sizeof(nombre), "%u", fin - debut));
+        ajouter_octet(sortie, rangee[debut]);
+        debut = fin;
+    }
+    ajouter_octet(sortie, '\n');
+}
+
+/**
+ * imprimer_canvas_rle - Affiche un canevas encodé par plages sur un flux.
+ *
+ * Écrit la ligne "RLE HAUTEUR,LARGEUR" puis une ligne de plages par
+ * rangée. Les rangées d'un canevas RLE qui n'ont jamais été décodées
+ * sont recopiées telles quelles.
+ *
+ * @param canvas Pointeur vers le canevas à imprimer.
+ * @param flux Flux de destination.
+ * @return size_t Nombre d'octets écrits sur le flux.
+ */
+size_t imprimer_canvas_rle(struct canvas *canvas, FILE *flux) {
+    char zone[TAILLE_TAMPON_SORTIE];
+    char entete[32];
+    TamponSortie sortie;
+
+    initialiser_tampon_sortie(&sortie, zone, sizeof(zone), flux);
+    ajouter_octets(&sortie, entete, snprintf(entete, sizeof(entete), "RLE %u,%u\n", canvas->height, canvas->width));
+    for (unsigned int i = 0; i < canvas->height; i++) {
+        if (canvas->rle != NULL && !canvas->rle->decodee[i]) {
+            const char *code = canvas->rle->donnees + canvas->rle->debuts[i];
+            ajouter_octets(&sortie, code, strlen(code));
+            ajouter_octet(&sortie, '\n');
+        } else {
+            ecrire_rangee_rle(&sortie, lire_rangee(canvas, i, canvas->rangee_lue), canvas->width);
+        }
+    }
+    vider_tampon_sortie(&sortie);
+    return sortie.octets_ecrits;
+}
+
+// Table des pixels acceptés : '.' et les couleurs '0' à '7'
+const unsigned char PIXELS_VALIDES[256] = {
+    ['.'] = 1, ['0'] = 1, ['1'] = 1, ['2'] = 1,
+    ['3'] = 1, ['4'] = 1, ['5'] = 1, ['6'] = 1, ['7'] = 1
+};
+
+/**
+ * est_pixel_valide - Vérifie si un caractère représente un pixel valide.
+ *
+ * Détermine si un caractère est un '.' ou un chiffre entre '0' et '7',
+ * indiquant un pixel valide, à l'aide de la table PIXELS_VALIDES.
+ *
+ * @param pixel Caractère à vérifier.
+ * @return int Retourne 1 si le pixel est valide, sinon 0.
+ */
+int est_pixel_valide(char pixel) {
+    return PIXELS_VALIDES[(unsigned char) pixel];
+}
+
+/**
+ * trouver_pixel_invalide - Cherche le premier pixel invalide d'une ligne.
+ *
+ * Lorsque SSE2 est disponible, vérifie 16 pixels à la fois par une
+ * comparaison d'intervalle vectorielle ('0' à '7') combinée à une égalité
+ * avec '.'. Le bloc fautif, et la fin de la ligne, sont examinés par la
+ * table PIXELS_VALIDES afin de repérer le pixel exact.
+ *
+ * @param ligne Pixels à valider.
+ * @param longueur Nombre de pixels de la ligne.
+ * @return size_t Indice du premier pixel invalide, ou longueur si tous sont valides.
+ */
+size_t trouver_pixel_invalide(const char *ligne, size_t longueur) {
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i avant_zero = _mm_set1_epi8('0' - 1);
+    const __m128i apres_sept = _mm_set1_epi8('7' + 1);
+    const __m128i point = _mm_set1_epi8('.');
+
+    for (; i + 16 <= longueur; i += 16) {
+        __m128i bloc = _mm_loadu_si128((const __m128i *) (ligne + i));
+        __m128i couleur = _mm_and_si128(_mm_cmpgt_epi8(bloc, avant_zero),
+                                        _mm_cmplt_epi8(bloc, apres_sept));
+        __m128i valide = _mm_or_si128(couleur, _mm_cmpeq_epi8(bloc, point));
+        if (_mm_movemask_epi8(valide) != 0xFFFF) break;
+    }
+#endif
+    for (; i < longueur; i++) {
+        if (!PIXELS_VALIDES[(unsigned char) ligne[i]]) return i;
+    }
+    return longueur;
+}
+
+/**
+ * agrandir_canvas - Double la capacité en rangées d'un canevas en cours de lecture.
+ *
+ * Alloue un nouveau tampon aligné, y recopie les rangées déjà lues
+ * et libère l'ancien tampon.
+ *
+ * @param canvas Pointeur vers le canevas à agrandir.
+ * @param capacite Pointeur vers la capacité courante, mise à jour.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si l'allocation échoue.
+ */
+enum error agrandir_canvas(struct canvas *canvas, unsigned int *capacite) {
+    unsigned int nouvelle_capacite = *capacite == 0 ? CAPACITE_INITIALE_RANGEES : *capacite * 2;
+    char *pixels = allouer_pixels(nouvelle_capacite, canvas->stride, ALIGNEMENT_PIXELS);
+
+    if (pixels == NULL) return ERR_OUT_OF_MEMORY;
+    if (canvas->pixels != NULL) {
+        memcpy(pixels, canvas->pixels, (size_t) canvas->height * canvas->stride);
+        free(canvas->pixels);
+    }
+    canvas->pixels = pixels;
+    *capacite = nouvelle_capacite;
+    return OK;
+}
+
+/**
+ * initialiser_lecteur_canvas - Prépare la lecture incrémentale d'un canevas.
+ *
+ * Vide le canevas, qui sera rempli au fil des blocs fournis à lire_bloc_canvas.
+ * Le canevas lu est toujours rangé par rangées; s'il est marqué compact
+ * (packed), ses rangées sont compactées au fil de la lecture.
+ *
+ * @param lecteur Pointeur vers le lecteur à initialiser.
+ * @param canvas Pointeur vers le canevas à remplir.
+ */
+void initialiser_lecteur_canvas(LecteurCanvas *lecteur, struct canvas *canvas) {
+    liberer_canvas(canvas);
+    canvas->height = 0;
+    canvas->width = 0;
+    canvas->tiled = 0;
+
+    lecteur->canvas = canvas;
+    lecteur->capacite = 0;
+    lecteur->reste = NULL;
+    lecteur->taille_reste = 0;
+    lecteur->capacite_reste = 0;
+    lecteur->pixel_invalide = '\0';
+}
+
+/**
+ * ajouter_rangee_lue - Valide une ligne complète et l'ajoute au canevas.
+ *
+ * La première ligne fixe la largeur du canevas; les suivantes doivent avoir
+ * la même longueur. Les vérifications se font dans le même ordre que la
+ * lecture ligne par ligne : largeur, rectangularité, puis pixels.
+ *
+ * @param lecteur Pointeur vers le lecteur.
+ * @param ligne Pixels de la ligne, sans saut de ligne.
+ * @param longueur Nombre de pixels de la ligne.
+ * @return enum error OK ou le code d'erreur de la ligne.
+ */
+enum error ajouter_rangee_lue(LecteurCanvas *lecteur, const char *ligne, size_t longueur) {
+    struct canvas *canvas = lecteur->canvas;
+
+    if (canvas->height == 0) {
+        if (longueur > UINT_MAX) return ERR_CANVAS_TOO_WIDE;
+        enum error erreur = verifier_dimensions(canvas, 0, longueur);
+        if (erreur != OK) return erreur;
+        canvas->width = longueur;
+        canvas->stride = calculer_pas_rangee(octets_par_rangee(canvas));
+    } else if (longueur != canvas->width) {
+        return ERR_CANVAS_NON_RECTANGULAR;
+    }
+
+    size_t indice_invalide = trouver_pixel_invalide(ligne, longueur);
+    if (indice_invalide < longueur) {
+        lecteur->pixel_invalide = ligne[indice_invalide];
+        return ERR_WRONG_PIXEL;
+    }
+
+    if (canvas->height == lecteur->capacite && agrandir_canvas(canvas, &lecteur->capacite) != OK) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    if (canvas->packed) emballer_pixels(rangee_canvas(canvas, canvas->height), ligne, longueur);
+    else memcpy(rangee_canvas(canvas, canvas->height), ligne, longueur);
+    canvas->height++;
+    return OK;
+}
+
+/**
+ * conserver_reste - Mémorise une ligne incomplète en fin de bloc.
+ *
+ * @param lecteur Pointeur vers le lecteur.
+ * @param octets Début de la ligne incomplète.
+ * @param nombre Nombre d'octets à ajouter au reste.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si l'allocation échoue.
+ */
+enum error conserver_reste(LecteurCanvas *lecteur, const char *octets, size_t nombre) {
+    if (lecteur->taille_reste + nombre > lecteur->capacite_reste) {
+        size_t capacite = lecteur->capacite_reste == 0 ? TAILLE_BLOC_LECTURE : lecteur->capacite_reste;
+        while (capacite < lecteur->taille_reste + nombre) capacite *= 2;
+
+        char *reste = realloc(lecteur->reste, capacite);
+        if (reste == NULL) return ERR_OUT_OF_MEMORY;
+        lecteur->reste = reste;
+        lecteur->capacite_reste = capacite;
+    }
+    memcpy(lecteur->reste + lecteur->taille_reste, octets, nombre);
+    lecteur->taille_reste += nombre;
+    return OK;
+}
+
+/**
+ * lire_bloc_canvas - Découpe un bloc d'octets en rangées du canevas.
+ *
+ * Repère les sauts de ligne avec memchr. Les lignes entièrement contenues
+ * dans le bloc sont validées et copiées directement depuis celui-ci; seule
+ * une ligne à cheval sur deux blocs transite par le reste du lecteur.
+ *
+ * @param lecteur Pointeur vers le lecteur.
+ * @param bloc Octets lus.
+ * @param taille Nombre d'octets du bloc.
+ * @return enum error OK ou le code de la première erreur rencontrée.
+ */
+enum error lire_bloc_canvas(LecteurCanvas *lecteur, const char *bloc, size_t taille) {
+    const char *debut = bloc;
+    const char *fin = bloc + taille;
+    enum error erreur = OK;
+
+    while (debut < fin && erreur == OK) {
+        const char *saut = memchr(debut, '\n', fin - debut);
+        if (saut == NULL) return conserver_reste(lecteur, debut, fin - debut);
+
+        if (lecteur->taille_reste > 0) {
+            erreur = conserver_reste(lecteur, debut, saut - debut);
+            if (erreur == OK) erreur = ajouter_rangee_lue(lecteur, lecteur->reste, lecteur->taille_reste);
+            lecteur->taille_reste = 0;
+        } else {
+            erreur = ajouter_rangee_lue(lecteur, debut, saut - debut);
+        }
+        debut = saut + 1;
+    }
+    return erreur;
+}
+
+/**
+ * terminer_lecture_canvas - Termine la lecture incrémentale d'un canevas.
+ *
+ * Traite une dernière ligne sans saut de ligne, vérifie la hauteur finale
+ * et libère le reste du lecteur.
+ *
+ * @param lecteur Pointeur vers le lecteur.
+ * @return enum error OK ou le code d'erreur.
+ */
+enum error terminer_lecture_canvas(LecteurCanvas *lecteur) {
+    struct canvas *canvas = lecteur->canvas;
+    enum error erreur = OK;
+
+    if (lecteur->taille_reste > 0) {
+        erreur = ajouter_rangee_lue(lecteur, lecteur->reste, lecteur->taille_reste);
+        lecteur->taille_reste = 0;
+    }
+    free(lecteur->reste);
+    lecteur->reste = NULL;
+    lecteur->capacite_reste = 0;
+
+    if (erreur == OK) erreur = verifier_dimensions(canvas, canvas->height, canvas->width);
+    if (erreur == OK && canvas->pixels == NULL) erreur = agrandir_canvas(canvas, &lecteur->capacite);
+    if (erreur == OK) erreur = allouer_rangee_lue(canvas);
+    return erreur;
+}
+
+/**
+ * lire_canvas - Charge un canevas depuis un flux.
+ *
+ * Lit le flux par blocs de TAILLE_BLOC_LECTURE octets et les confie au
+ * lecteur incrémental, qui valide la uniformité de la largeur et la
+ * validité des pixels. La lecture s'arrête à la première erreur.
+ *
+ * @param flux Flux à lire, stdin pour la ligne de commande.
+ * @param canvas Pointeur vers le canevas à remplir, à libérer même en cas d'erreur.
+ * @param octets_lus Reçoit le nombre d'octets lus.
+ * @param pixel_invalide Reçoit le pixel fautif pour ERR_WRONG_PIXEL.
+ * @return enum error OK ou le code de la première erreur.
+ */
+enum error lire_canvas(FILE *flux, struct canvas *canvas, size_t *octets_lus, char *pixel_invalide) {
+    LecteurCanvas lecteur;
+    enum error erreur = OK;
+    char *bloc = malloc(TAILLE_BLOC_LECTURE);
+    size_t taille;
+
+    *octets_lus = 0;
+    initialiser_lecteur_canvas(&lecteur, canvas);
+    if (bloc == NULL) return ERR_OUT_OF_MEMORY;
+
+    while (erreur == OK && (taille = fread(bloc, 1, TAILLE_BLOC_LECTURE, flux)) > 0) {
+        erreur = lire_bloc_canvas(&lecteur, bloc, taille);
+        *octets_lus += taille;
+    }
+    free(bloc);
+    if (erreur == OK) {
+        erreur = terminer_lecture_canvas(&lecteur);
+    } else {
+        free(lecteur.reste);
+    }
+    *pixel_invalide = lecteur.pixel_invalide;
+    return erreur;
+}
+
+/**
+ * indexer_rangees_rle - Valide un canevas RLE et repère le début de ses rangées.
+ *
+ * Après la ligne "RLE HAUTEUR,LARGEUR", chaque rangée est une suite de
+ * plages séparées par une espace : un pixel, précédé de sa répétition si
+ * elle dépasse 1. Le dernier caractère d'une plage est donc toujours le
+ * pixel, même si c'est un chiffre. Chaque fin de ligne est remplacée par
+ * '\0' pour que les rangées puissent être décodées séparément.
+ *
+ * @param canvas Pointeur vers le canevas, dont les dimensions sont fixées.
+ * @param source Source RLE, dont donnees contient taille octets et un '\0'.
+ * @param taille Nombre d'octets lus.
+ * @param pixel_invalide Reçoit le caractère fautif pour ERR_WRONG_PIXEL.
+ * @return enum error OK, ERR_WRONG_PIXEL, ERR_CANVAS_NON_RECTANGULAR,
+ * ERR_CANVAS_TOO_HIGH, ERR_CANVAS_TOO_WIDE ou ERR_OUT_OF_MEMORY.
+ */
+enum error indexer_rangees_rle(struct canvas *canvas, SourceRLE *source, size_t taille, char *pixel_invalide) {
+    char *code = source->donnees;
+    char *fin_donnees = source->donnees + taille;
+    unsigned long hauteur, largeur;
+
+    *pixel_invalide = code[0];
+    if (strncmp(code, "RLE ", 4) != 0 || !isdigit((unsigned char) code[4])) return ERR_WRONG_PIXEL;
+    hauteur = strtoul(code + 4, &code, 10);
+    *pixel_invalide = *code;
+    if (*code != ',' || !isdigit((unsigned char) code[1])) return ERR_WRONG_PIXEL;
+    largeur = strtoul(code + 1, &code, 10);
+    *pixel_invalide = *code;
+    if (*code++ != '\n') return ERR_WRONG_PIXEL;
+    if (hauteur > UINT_MAX) return ERR_CANVAS_TOO_HIGH;
+    if (largeur > UINT_MAX) return ERR_CANVAS_TOO_WIDE;
+
+    enum error erreur = verifier_dimensions(canvas, hauteur, largeur);
+    if (erreur != OK) return erreur;
+    canvas->height = hauteur;
+    canvas->width = largeur;
+    source->debuts = malloc((hauteur ? hauteur : 1) * sizeof(size_t));
+    source->decodee = calloc(hauteur ? hauteur : 1, 1);
+    if (source->debuts == NULL || source->decodee == NULL) return ERR_OUT_OF_MEMORY;
+
+    for (unsigned long rangee = 0; rangee < hauteur; rangee++) {
+        unsigned long colonne = 0;
+
+        if (code >= fin_donnees) return ERR_CANVAS_NON_RECTANGULAR; // Rangées manquantes
+        source->debuts[rangee] = code - source->donnees;
+        while (colonne < largeur) {
+            size_t longueur = strcspn(code, " \n");
+            unsigned long nombre = longueur > 1 ? 0 : 1;
+
+            if (longueur == 0) return ERR_CANVAS_NON_RECTANGULAR;
+            for (size_t i = 0; i + 1 < longueur; i++) {
+                if (!isdigit((unsigned char) code[i])) {
+                    *pixel_invalide = code[i];
+                    return ERR_WRONG_PIXEL;
+                }
+                nombre = nombre * 10 + (code[i] - '0');
+                if (nombre > largeur) return ERR_CANVAS_NON_RECTANGULAR;
+            }
+            if (!est_pixel_valide(code[longueur - 1])) {
+                *pixel_invalide = code[longueur - 1];
+                return ERR_WRONG_PIXEL;
+            }
+            if (nombre == 0 || nombre > largeur - colonne) return ERR_CANVAS_NON_RECTANGULAR;
+            colonne += nombre;
+            code += longueur;
+            if (colonne < largeur && *code++ != ' ') return ERR_CANVAS_NON_RECTANGULAR;
+        }
+        if (*code != '\n' && *code != '\0') return ERR_CANVAS_NON_RECTANGULAR;
+        if (*code == '\n') *code++ = '\0';
+    }
+    while (code < fin_donnees && *code == '\n') code++; // Lignes vides finales tolérées
+    return code == fin_donnees ? OK : ERR_CANVAS_NON_RECTANGULAR;
+}
+
+/**
+ * lire_canvas_rle - Charge un canevas encodé par plages depuis un flux.
+ *
+ * Le texte est lu en entier et validé, mais les pixels ne sont pas
+ * décodés : le canevas est alloué vide, dans la disposition demandée, et
+ * chaque rangée n'est décodée que lorsqu'une commande la touche ou que le
+ * canevas est imprimé autrement qu'en RLE. En cas d'erreur, le texte lu
+ * est libéré et le canevas reste sans pixels.
+ *
+ * @param flux Flux à lire, stdin pour la ligne de commande.
+ * @param canvas Pointeur vers le canevas à remplir, dont tiled et packed sont fixés.
+ * @param octets_lus Reçoit le nombre d'octets lus.
+ * @param pixel_invalide Reçoit le pixel fautif pour ERR_WRONG_PIXEL.
+ * @return enum error OK ou le code de la première erreur.
+ */
+enum error lire_canvas_rle(FILE *flux, struct canvas *canvas, size_t *octets_lus, char *pixel_invalide) {
+    SourceRLE *source = calloc(1, sizeof(SourceRLE));
+    size_t capacite = TAILLE_BLOC_LECTURE;
+    size_t taille = 0, lus;
+    enum error erreur = OK;
+
+    *octets_lus = 0;
+    *pixel_invalide = '\0';
+    if (source == NULL || (source->donnees = malloc(capacite)) == NULL) erreur = ERR_OUT_OF_MEMORY;
+    while (erreur == OK && (lus = fread(source->donnees + taille, 1, capacite - taille - 1, flux)) > 0) {
+        taille += lus;
+        if (capacite - taille == 1) {
+            char *agrandies = realloc(source->donnees, capacite * 2);
+            if (agrandies == NULL) {
+                erreur = ERR_OUT_OF_MEMORY;
+                break;
+            }
+            source->donnees = agrandies;
+            capacite *= 2;
+        }
+    }
+    *octets_lus = taille;
+
+    if (erreur == OK) {
+        source->donnees[taille] = '\0';
+        erreur = indexer_rangees_rle(canvas, source, taille, pixel_invalide);
+    }
+    if (erreur == OK) erreur = allouer_canvas(canvas);
+    if (erreur != OK) {
+        if (source != NULL) {
+            free(source->donnees);
+            free(source->debuts);
+            free(source->decodee);
+            free(source);
+        }
+        return erreur;
+    }
+    source->capacite = capacite;
+    canvas->rle = source;
+    return OK;
+}
+
+/**
+ * charger_canvas_binaire - Projette en mémoire un canevas binaire.
+ *
+ * Le fichier est projeté en copie privée : les routines de tracé
+ * modifient directement les pages projetées, sans copie préalable des
+ * pixels et sans jamais modifier le fichier. L'en-tête est vérifiée
+ * (signature, version, disposition, pas, taille du fichier) et le
+ * canevas adopte la disposition du fichier.
+ *
+ * @param canvas Pointeur vers le canevas à initialiser.
+ * @param chemin Chemin du fichier binaire.
+ * @return enum error OK, ERR_WITH_VALUE si le fichier est illisible ou
+ * invalide, ou ERR_CANVAS_TOO_HIGH ou ERR_CANVAS_TOO_WIDE.
+ */
+enum error charger_canvas_binaire(struct canvas *canvas, const char *chemin) {
+    int descripteur = open(chemin, O_RDONLY);
+    struct stat etat;
+    EnteteBinaire entete;
+
+    if (descripteur < 0) return ERR_WITH_VALUE;
+    if (fstat(descripteur, &etat) != 0 || etat.st_size < (off_t) sizeof(entete)
+            || read(descripteur, &entete, sizeof(entete)) != (ssize_t) sizeof(entete)) {
+        close(descripteur);
+        return ERR_WITH_VALUE;
+    }
+
+    struct canvas lu = {0};
+    lu.height = entete.height;
+    lu.width = entete.width;
+    lu.tiled = (entete.disposition & DISPOSITION_TUILES) != 0;
+    lu.packed = (entete.disposition & DISPOSITION_COMPACTE) != 0;
+    lu.limitee = canvas->limitee;
+    enum error erreur = memcmp(entete.magie, MAGIE_BINAIRE, sizeof(entete.magie)) == 0
+                        && entete.version == VERSION_BINAIRE ? OK : ERR_WITH_VALUE;
+    size_t taille = (size_t) etat.st_size;
+
+    if (erreur == OK) erreur = verifier_dimensions(&lu, lu.height, lu.width);
+    if (erreur == OK && ((entete.disposition & ~(DISPOSITION_TUILES | DISPOSITION_COMPACTE)) != 0
+            || entete.stride != calculer_pas_canvas(&lu)
+            || entete.decalage != alignement_pixels(&lu)
+            || taille < entete.decalage
+            || (entete.stride != 0   // Sans colonnes, les rangées n'occupent aucun octet
+                && (taille - entete.decalage) / entete.stride < nombre_rangees_stockees(&lu)))) {
+        erreur = ERR_WITH_VALUE;
+    }
+    if (erreur != OK) {
+        close(descripteur);
+        return erreur;
+    }
+
+    lu.projection = mmap(NULL, taille, PROT_READ | PROT_WRITE, MAP_PRIVATE, descripteur, 0);
+    close(descripteur);
+    if (lu.projection == MAP_FAILED) return ERR_WITH_VALUE;
+    lu.taille_projection = taille;
+    lu.pixels = lu.projection + entete.decalage;
+    lu.stride = entete.stride;
+    if (allouer_rangee_lue(&lu) != OK) {
+        liberer_canvas(&lu);
+        return ERR_OUT_OF_MEMORY;
+    }
+    *canvas = lu;
+    return OK;
+}
+
+/**
+ * enregistrer_canvas_binaire - Enregistre un canevas dans le format binaire.
+ *
+ * L'en-tête, complétée de zéros jusqu'à l'alignement des pixels, et les
+ * pixels, tels qu'ils sont en mémoire, sont transmis en une seule écriture
+ * dans un fichier temporaire qui remplace ensuite le fichier demandé. Un
+ * canevas projeté depuis ce même fichier reste ainsi valide.
+ *
+ * @param canvas Pointeur vers le canevas à enregistrer.
+ * @param chemin Chemin du fichier binaire.
+ * @return enum error OK, ERR_WITH_VALUE si le fichier ne peut être écrit,
+ * ou ERR_OUT_OF_MEMORY.
+ */
+enum error enregistrer_canvas_binaire(const struct canvas *canvas, const char *chemin) {
+    size_t decalage = alignement_pixels(canvas);
+    char *temporaire = malloc(strlen(chemin) + sizeof(".XXXXXX"));
+    char *entete = calloc(1, decalage);
+    EnteteBinaire champs = {
+        .version = VERSION_BINAIRE,
+        .height = canvas->height,
+        .width = canvas->width,
+        .disposition = (canvas->tiled ? DISPOSITION_TUILES : 0) | (canvas->packed ? DISPOSITION_COMPACTE : 0),
+        .stride = canvas->stride,
+        .decalage = decalage
+    };
+
+    if (temporaire == NULL || entete == NULL) {
+        free(entete);
+        free(temporaire);
+        return ERR_OUT_OF_MEMORY;
+    }
+    memcpy(champs.magie, MAGIE_BINAIRE, sizeof(champs.magie));
+    memcpy(entete, &champs, sizeof(champs));
+    sprintf(temporaire, "%s.XXXXXX", chemin);
+
+    struct iovec morceaux[2] = {
+        {entete, decalage},
+        {canvas->pixels, nombre_rangees_stockees(canvas) * canvas->stride}
+    };
+    size_t restant = morceaux[0].iov_len + morceaux[1].iov_len;
+    int descripteur = mkstemp(temporaire);
+    enum error erreur = descripteur < 0 ? ERR_WITH_VALUE : OK;
+
+    while (erreur == OK && restant > 0) {
+        struct iovec *morceau = morceaux[0].iov_len > 0 ? &morceaux[0] : &morceaux[1];
+        ssize_t ecrits = writev(descripteur, morceau, (int) (morceaux + 2 - morceau));
+
+        if (ecrits < 0 && errno == EINTR) continue;
+        if (ecrits <= 0) {
+            erreur = ERR_WITH_VALUE;
+            break;
+        }
+        restant -= ecrits;
+        for (; ecrits > 0; morceau++) { // Écriture partielle : on reprend où elle s'est arrêtée
+            size_t partie = (size_t) ecrits < morceau->iov_len ? (size_t) ecrits : morceau->iov_len;
+            morceau->iov_base = (char *) morceau->iov_base + partie;
+            morceau->iov_len -= partie;
+            ecrits -= partie;
+        }
+    }
+    if (descripteur >= 0) {
+        if (erreur == OK && (fchmod(descripteur, 0644) != 0 || close(descripteur) != 0)) erreur = ERR_WITH_VALUE;
+        else if (erreur != OK) close(descripteur);
+        if (erreur == OK && rename(temporaire, chemin) != 0) erreur = ERR_WITH_VALUE;
+        if (erreur != OK) unlink(temporaire);
+    }
+    free(entete);
+    free(temporaire);
+    return erreur;
+}
+
+/**
+ * remplir_octets - Écrit le crayon sur des pixels contigus.
+ *
+ * Les plages longues passent par memset, qui écrit par blocs vectoriels;
+ * les plages courtes, typiques des cercles, sont écrites octet par octet
+ * pour éviter le coût de l'appel.
+ *
+ * @param pixels Adresse du premier pixel.
+ * @param pen Caractère à écrire.
+ * @param nombre Nombre de pixels, éventuellement nul.
+ */
+void remplir_octets(char *pixels, char pen, size_t nombre) {
+    if (nombre >= SEUIL_MEMSET) {
+        memset(pixels, pen, nombre);
+        return;
+    }
+    for (size_t i = 0; i < nombre; i++) {
+        pixels[i] = pen;
+    }
+}
+
+/**
+ * remplir_quartets - Écrit le crayon sur des pixels compactés contigus.
+ *
+ * Un éventuel premier pixel de rang impair et un éventuel dernier pixel
+ * de rang pair partagent leur octet avec un voisin et sont écrits par
+ * masque; tous les octets entre les deux sont remplis d'un coup.
+ *
+ * @param octets Octet contenant le premier pixel.
+ * @param impair 1 si le premier pixel occupe les 4 bits de poids fort.
+ * @param pen Caractère à écrire.
+ * @param nombre Nombre de pixels, éventuellement nul.
+ */
+void remplir_quartets(char *octets, int impair, char pen, size_t nombre) {
+    unsigned char code = coder_pixel(pen);
+
+    if (nombre == 0) return;
+    if (impair) {
+        *octets = (char) ((*octets & 0x0F) | code << 4);
+        octets++;
+        nombre--;
+    }
+    remplir_octets(octets, (char) (code | code << 4), nombre / 2);
+    if (nombre % 2 != 0) {
+        octets += nombre / 2;
+        *octets = (char) ((*octets & 0xF0) | code);
+    }
+}
+
+/**
+ * remplir_rangee - Remplit une plage de colonnes d'une rangée avec le crayon.
+ *
+ * Noyau commun de tous les tracés horizontaux. En disposition par tuiles,
+ * la plage est découpée aux frontières des tuiles; en disposition
+ * compacte, chaque morceau est rempli par remplir_quartets. Aucune
+ * vérification de bornes n'est faite.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée, comprise dans le canevas.
+ * @param colonne_debut Première colonne (incluse), comprise dans le canevas.
+ * @param colonne_fin Dernière colonne (exclue), au plus la largeur du canevas.
+ */
+void remplir_rangee(struct canvas *canvas, long rangee, long colonne_debut, long colonne_fin) {
+    canvas->pixels_ecrits += colonne_fin - colonne_debut;
+    if (canvas->modifs != NULL) marquer_modification(canvas, rangee, colonne_debut, colonne_fin);
+    if (!canvas->tiled && !canvas->packed) {
+        remplir_octets(pixel_canvas(canvas, rangee, colonne_debut), canvas->pen, colonne_fin - colonne_debut);
+        return;
+    }
+    while (colonne_debut < colonne_fin) {
+        long fin_morceau = colonne_fin;
+        if (canvas->tiled && fin_morceau > (colonne_debut / COTE_TUILE + 1) * COTE_TUILE) {
+            fin_morceau = (colonne_debut / COTE_TUILE + 1) * COTE_TUILE;
+        }
+
+        char *octets = pixel_canvas(canvas, rangee, colonne_debut);
+        if (canvas->packed) {
+            remplir_quartets(octets, colonne_debut % 2, canvas->pen, fin_morceau - colonne_debut);
+        } else {
+            remplir_octets(octets, canvas->pen, fin_morceau - colonne_debut);
+        }
+        colonne_debut = fin_morceau;
+    }
+}
+
+/**
+ * remplir_colonne - Remplit une plage de rangées d'une colonne avec le crayon.
+ *
+ * Noyau commun de tous les tracés verticaux. En disposition par tuiles,
+ * les pixels d'une même tuile sont séparés de COTE_TUILE octets seulement
+ * (la moitié en disposition compacte) et la colonne ne change de tuile que
+ * toutes les COTE_TUILE rangées. En disposition compacte, tous les pixels
+ * de la colonne occupent la même moitié de leur octet et sont écrits avec
+ * un même masque. Aucune vérification de bornes n'est faite.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param colonne Colonne, comprise dans le canevas.
+ * @param rangee_debut Première rangée (incluse), comprise dans le canevas.
+ * @param rangee_fin Dernière rangée (exclue), au plus la hauteur du canevas.
+ */
+void remplir_colonne(struct canvas *canvas, long colonne, long rangee_debut, long rangee_fin) {
+    size_t saut = canvas->tiled ? (size_t) COTE_TUILE >> canvas->packed : canvas->stride;
+    int decalage = (colonne % 2) * 4;
+    char masque = canvas->packed ? (char) ~(0x0F << decalage) : 0;
+    char valeur = canvas->packed ? (char) (coder_pixel(canvas->pen) << decalage) : canvas->pen;
+
+    canvas->pixels_ecrits += rangee_fin - rangee_debut;
+    for (long rangee = rangee_debut; canvas->modifs != NULL && rangee < rangee_fin; rangee++) {
+        marquer_modification(canvas, rangee, colonne, colonne + 1);
+    }
+    while (rangee_debut < rangee_fin) {
+        long fin_tuile = rangee_fin;
+        if (canvas->tiled && fin_tuile > (rangee_debut / COTE_TUILE + 1) * COTE_TUILE) {
+            fin_tuile = (rangee_debut / COTE_TUILE + 1) * COTE_TUILE;
+        }
+
+        char *pixel = pixel_canvas(canvas, rangee_debut, colonne);
+        for (; rangee_debut < fin_tuile; rangee_debut++, pixel += saut) {
+            *pixel = (*pixel & masque) | valeur;
+        }
+    }
+}
+
+/**
+ * decoder_rangees - Décode dans les pixels les rangées RLE d'une plage.
+ *
+ * Les rangées déjà décodées sont sautées. Les pixels d'un canevas RLE
+ * valent '.' tant que leur rangée n'est pas décodée : seules les plages
+ * d'une autre couleur sont tracées, avec remplir_rangee, sur une copie
+ * du canevas qui ne suit ni les modifications ni la source RLE. Des
+ * threads peuvent décoder en même temps des plages de rangées disjointes.
+ *
+ * @param canvas Pointeur vers le canevas, qui peut ne pas avoir de source RLE.
+ * @param rangee_debut Première rangée (incluse).
+ * @param rangee_fin Dernière rangée (exclue), au plus la hauteur du canevas.
+ */
+void decoder_rangees(struct canvas *canvas, long rangee_debut, long rangee_fin) {
+    SourceRLE *source = canvas->rle;
+    struct canvas copie = *canvas;
+
+    if (source == NULL) return;
+    copie.modifs = NULL;
+    copie.rle = NULL;
+    for (long rangee = rangee_debut; rangee < rangee_fin; rangee++) {
+        const char *code = source->donnees + source->debuts[rangee];
+        long colonne = 0;
+
+        if (source->decodee[rangee]) continue;
+        while (colonne < canvas->width) {
+            size_t longueur = strcspn(code, " ");
+            long nombre = longueur > 1 ? 0 : 1;
+
+            for (size_t i = 0; i + 1 < longueur; i++) nombre = nombre * 10 + (code[i] - '0');
+            copie.pen = code[longueur - 1];
+            if (copie.pen != '.') remplir_rangee(&copie, rangee, colonne, colonne + nombre);
+            colonne += nombre;
+            code += longueur + 1;
+        }
+        source->decodee[rangee] = 1;
+    }
+}
+
+/**
+ * tracer_ligne_horizontale - Trace une ligne horizontale sur un canevas.
+ *
+ * Trace une ligne horizontale à la rangée donnée en utilisant le stylo
+ * défini dans le canevas sur toute la largeur de la fenêtre.
+ *
+ * @param canvas Pointeur vers le canevas sur lequel la ligne sera tracée.
+ * @param fenetre Fenêtre de rognage.
+ * @param rangee Indice de la rangée, inférieur à la hauteur du canevas.
+ */
+void tracer_ligne_horizontale(struct canvas *canvas, const Fenetre *fenetre, unsigned int rangee) {
+    if (rangee < fenetre->rangee_debut || rangee >= fenetre->rangee_fin) return;
+    remplir_rangee(canvas, rangee, fenetre->colonne_debut, fenetre->colonne_fin);
+}
+
+/**
+ * tracer_ligne_verticale - Trace une ligne verticale sur un canevas.
+ *
+ * Trace une ligne verticale à la colonne donnée en utilisant le stylo
+ * défini dans le canevas sur toute la hauteur de la fenêtre.
+ *
+ * @param canvas Pointeur vers le canevas sur lequel la ligne sera tracée.
+ * @param fenetre Fenêtre de rognage.
+ * @param colonne Indice de la colonne, inférieur à la largeur du canevas.
+ */
+void tracer_ligne_verticale(struct canvas *canvas, const Fenetre *fenetre, unsigned int colonne) {
+    if (colonne < fenetre->colonne_debut || colonne >= fenetre->colonne_fin) return;
+    remplir_colonne(canvas, colonne, fenetre->rangee_debut, fenetre->rangee_fin);
+}
+
+/**
+ * recuperer_indice - Extrait l'indice de rangée ou de colonne d'une option.
+ *
+ * Vérifie que la valeur fournie n'est ni nulle ni vide et qu'elle est
+ * numérique. Une valeur négative devient un indice hors limites, refusé
+ * au moment du tracé.
+ *
+ * @param valeur Chaîne représentant l'indice.
+ * @param indice Pointeur vers l'indice converti.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error recuperer_indice(char *valeur, unsigned int *indice) {
+    int indice_entier = 0;
+
+    if (est_valeur_absente(valeur)) return ERR_MISSING_VALUE;
+    if (convertir_entier(valeur, &indice_entier) != OK) return ERR_WITH_VALUE;
+    *indice = indice_entier;
+    return OK;
+}
+
+/**
+ * recuperer_epaisseur - Extrait l'épaisseur des traits de l'option -w.
+ *
+ * L'épaisseur doit être un entier strictement positif; 1 redonne les
+ * traits d'un pixel.
+ *
+ * @param valeur Chaîne représentant l'épaisseur.
+ * @param epaisseur Pointeur vers l'épaisseur convertie.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error recuperer_epaisseur(char *valeur, unsigned int *epaisseur) {
+    int epaisseur_entiere = 0;
+
+    if (est_valeur_absente(valeur)) return ERR_MISSING_VALUE;
+    if (convertir_entier(valeur, &epaisseur_entiere) != OK || est_negatif(epaisseur_entiere)) {
+        return ERR_WITH_VALUE;
+    }
+    *epaisseur = epaisseur_entiere;
+    return OK;
+}
+
+/**
+ * recuperer_parametres_rectangle - Extrait les paramètres d'un rectangle 
+ * à partir d'une chaîne de caractères séparée par des virgules.
+ *
+ * Analyse une chaîne contenant quatre valeurs numériques séparées par
+ * des virgules, représentant respectivement la position y, la position x,
+ * la hauteur et la largeur d'un rectangle.  
+ * 
+ * @param parametres_str Chaîne contenant les paramètres du rectangle.
+ * @param rectangle Pointeur vers le rectangle initialisé avec les dimensions
+ * et la position parsées.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error recuperer_parametres_rectangle(char *parametres_str, Rectangle *rectangle) {
+    unsigned int indice_dimension_courant = 0;
+    *rectangle = (Rectangle) {0};
+
+    if (est_valeur_absente(parametres_str)) return ERR_MISSING_VALUE;
+
+    char *suite = NULL;
+    char *parametre_courant = strtok_r(parametres_str, ",", &suite);
+    while (parametre_courant != NULL && indice_dimension_courant < 4) {
+        int parametre_int = 0;
+        if (convertir_entier(parametre_courant, &parametre_int) != OK) return ERR_WITH_VALUE;
+        switch (indice_dimension_courant) {
+            case 0:
+                rectangle->position.y = parametre_int;
+                break;
+            case 1:
+                rectangle->position.x = parametre_int;
+                break;
+            case 2:
+                rectangle->height = parametre_int;
+                break;
+            case 3:
+                rectangle->width = parametre_int;
+                break;
+        }
+        indice_dimension_courant++;
+        parametre_courant = strtok_r(NULL, ",", &suite);
+    }
+
+    if (est_negatif(rectangle->height) || est_negatif(rectangle->width)) return ERR_WITH_VALUE;
+    if (indice_dimension_courant != 4) return ERR_MISSING_VALUE;
+    return OK;
+}
+
+/**
+ * borner - Ramène une valeur dans l'intervalle [minimum, maximum].
+ *
+ * @param valeur Valeur à borner.
+ * @param minimum Borne inférieure.
+ * @param maximum Borne supérieure.
+ * @return long La valeur bornée.
+ */
+long borner(long valeur, long minimum, long maximum) {
+    if (valeur < minimum) return minimum;
+    if (valeur > maximum) return maximum;
+    return valeur;
+}
+
+/**
+ * fenetre_canvas - Retourne la fenêtre de rognage couvrant tout un canevas.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @return Fenetre Rangées et colonnes visibles du canevas.
+ */
+Fenetre fenetre_canvas(const struct canvas *canvas) {
+    return (Fenetre) {0, canvas->height, 0, canvas->width};
+}
+
+/**
+ * rogner_pas - Rogne une suite de positions régulières contre un intervalle.
+ *
+ * Les positions sont origine + direction * k pour k de 0 à nombre_pas. Le
+ * calcul, celui de Liang-Barsky sur un seul axe, donne en une fois les pas
+ * dont la position tombe dans [debut, fin), sans parcourir les autres.
+ *
+ * @param origine Position au pas 0.
+ * @param direction 1 ou -1.
+ * @param nombre_pas Dernier pas de la suite.
+ * @param debut Première position visible (incluse).
+ * @param fin Dernière position visible (exclue).
+ * @param premier Pointeur vers le premier pas visible.
+ * @param dernier Pointeur vers le dernier pas visible.
+ * @return int 1 si au moins un pas est visible, 0 sinon.
+ */
+int rogner_pas(long long origine, int direction, long long nombre_pas,
+               long long debut, long long fin, long long *premier, long long *dernier) {
+    if (direction > 0) {
+        *premier = debut - origine;
+        *dernier = fin - 1 - origine;
+    } else {
+        *premier = origine - (fin - 1);
+        *dernier = origine - debut;
+    }
+    if (*premier < 0) *premier = 0;
+    if (*dernier > nombre_pas) *dernier = nombre_pas;
+    return *premier <= *dernier;
+}
+
+/**
+ * remplir_plage - Trace une suite de colonnes d'une rangée visible.
+ *
+ * Les colonnes sont rognées une seule fois contre la fenêtre, puis la
+ * plage est remplie sans autre vérification.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param fenetre Fenêtre de rognage.
+ * @param rangee Rangée, déjà comprise dans la fenêtre.
+ * @param colonne_debut Première colonne (incluse).
+ * @param colonne_fin Dernière colonne (exclue).
+ */
+void remplir_plage(struct canvas *canvas, const Fenetre *fenetre, long rangee,
+                   long long colonne_debut, long long colonne_fin) {
+    if (colonne_debut < fenetre->colonne_debut) colonne_debut = fenetre->colonne_debut;
+    if (colonne_fin > fenetre->colonne_fin) colonne_fin = fenetre->colonne_fin;
+    if (colonne_debut < colonne_fin) remplir_rangee(canvas, rangee, colonne_debut, colonne_fin);
+}
+
+/**
+ * tracer_ligne_rectangle - Trace un côté horizontal d'un rectangle, rogné à la fenêtre.
+ *
+ * @param canvas Pointeur vers le canevas sur lequel tracer la ligne.
+ * @param fenetre Fenêtre de rognage.
+ * @param y Rangée du côté.
+ * @param x1 Première colonne (incluse).
+ * @param x2 Dernière colonne (exclue).
+ */
+void tracer_ligne_rectangle(struct canvas *canvas, const Fenetre *fenetre, long y, long x1, long x2) {
+    if (y < fenetre->rangee_debut || y >= fenetre->rangee_fin) return;
+    remplir_plage(canvas, fenetre, y, x1, x2);
+}
+
+/**
+ * tracer_colonne_rectangle - Trace un côté vertical d'un rectangle, rogné à la fenêtre.
+ *
+ * @param canvas Pointeur vers le canevas sur lequel tracer la ligne.
+ * @param fenetre Fenêtre de rognage.
+ * @param x Colonne du côté.
+ * @param y1 Première rangée (incluse).
+ * @param y2 Dernière rangée (exclue).
+ */
+void tracer_colonne_rectangle(struct canvas *canvas, const Fenetre *fenetre, long x, long y1, long y2) {
+    if (x < fenetre->colonne_debut || x >= fenetre->colonne_fin) return;
+    y1 = borner(y1, fenetre->rangee_debut, fenetre->rangee_fin);
+    y2 = borner(y2, fenetre->rangee_debut, fenetre->rangee_fin);
+    remplir_colonne(canvas, x, y1, y2);
+}
+
+/**
+ * tracer_largeur_haut_rectangle - Trace la ligne supérieure d'un rectangle sur un canevas.
+ *
+ * @param rectangle Structure contenant les paramètres du rectangle à tracer.
+ * @param canvas Pointeur vers le canevas sur lequel tracer la ligne.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_largeur_haut_rectangle(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre) {
+    // Détermine la coordonnée y où la ligne doit être tracée
+    long y = rectangle.position.y;
+    long x2 = (long) rectangle.position.x + rectangle.width;
+
+    tracer_ligne_rectangle(canvas, fenetre, y, rectangle.position.x, x2);
+}
+
+/**
+ * tracer_largeur_bas_rectangle - Trace la ligne inférieure d'un rectangle sur un canevas.
+ *
+ * @param rectangle Structure contenant les paramètres du rectangle.
+ * @param canvas Pointeur vers le canevas sur lequel tracer la ligne.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_largeur_bas_rectangle(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre) {
+    // Détermine la coordonnée y où la ligne doit être tracée
+    long y = rectangle.position.y;
+    long x2 = (long) rectangle.position.x + rectangle.width;
+    long y2 = y + rectangle.height - 1;
+    // Dessine une ligne horizontale à la position y du canvas
+    tracer_ligne_rectangle(canvas, fenetre, y2, rectangle.position.x, x2);
+}
+
+/**
+ * tracer_longueur_droite_rectangle - Trace le côté droit d'un rectangle sur un canevas.
+ *
+ *
+ * @param rectangle Structure du rectangle avec les dimensions et la position.
+ * @param canvas Pointeur vers le canevas où tracer la ligne.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_longueur_droite_rectangle(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre) {
+    // Détermine la coordonnée y où la ligne doit être tracée
+    long y2 = (long) rectangle.position.y + rectangle.height;
+    long x2 = (long) rectangle.position.x + rectangle.width;
+
+    tracer_colonne_rectangle(canvas, fenetre, x2 - 1, rectangle.position.y, y2);
+}
+
+/**
+ * tracer_longueur_gauche_rectangle - Trace le côté gauche d'un rectangle sur un canevas.
+ *
+ *
+ * @param rectangle Structure du rectangle spécifiant la position et les dimensions.
+ * @param canvas Pointeur vers le canevas sur lequel le rectangle est tracé.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_longueur_gauche_rectangle(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre) {
+    long y2 = (long) rectangle.position.y + rectangle.height;
+    long x = rectangle.position.x;
+
+    tracer_colonne_rectangle(canvas, fenetre, x, rectangle.position.y, y2);
+}
+
+/**
+ * tracer_rectangle - Trace un rectangle complet sur un canevas.
+ *
+ * Appelle des fonctions spécifiques pour tracer chaque côté du rectangle défini par la
+ * structure rectangle sur le canevas fourni.
+ * Trace les lignes haut, bas, gauche et droite du rectangle.
+ *
+ * @param rectangle Structure contenant les paramètres du rectangle à tracer.
+ * @param canvas Pointeur vers le canevas sur lequel le rectangle sera tracé.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_rectangle(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre) {
+    tracer_largeur_haut_rectangle(rectangle, canvas, fenetre);
+    tracer_longueur_droite_rectangle(rectangle, canvas, fenetre);
+    tracer_longueur_gauche_rectangle(rectangle, canvas, fenetre);
+    tracer_largeur_bas_rectangle(rectangle, canvas, fenetre);
+
+}
+
+/**
+ * remplir_boite - Remplit un bloc de rangées et de colonnes, rogné à la fenêtre.
+ *
+ * Le bloc est rogné une seule fois, puis chaque rangée visible est
+ * remplie d'une seule plage.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param fenetre Fenêtre de rognage.
+ * @param rangee_debut Première rangée (incluse).
+ * @param rangee_fin Dernière rangée (exclue).
+ * @param colonne_debut Première colonne (incluse).
+ * @param colonne_fin Dernière colonne (exclue).
+ */
+void remplir_boite(struct canvas *canvas, const Fenetre *fenetre, long rangee_debut, long rangee_fin,
+                   long colonne_debut, long colonne_fin) {
+    rangee_debut = borner(rangee_debut, fenetre->rangee_debut, fenetre->rangee_fin);
+    rangee_fin = borner(rangee_fin, fenetre->rangee_debut, fenetre->rangee_fin);
+    colonne_debut = borner(colonne_debut, fenetre->colonne_debut, fenetre->colonne_fin);
+    colonne_fin = borner(colonne_fin, fenetre->colonne_debut, fenetre->colonne_fin);
+
+    if (colonne_debut >= colonne_fin) return;
+    for (long rangee = rangee_debut; rangee < rangee_fin; rangee++) {
+        remplir_rangee(canvas, rangee, colonne_debut, colonne_fin);
+    }
+}
+
+/**
+ * remplir_rectangle - Trace un rectangle plein sur un canevas.
+ *
+ * @param rectangle Structure contenant les paramètres du rectangle à remplir.
+ * @param canvas Pointeur vers le canevas sur lequel le rectangle sera tracé.
+ * @param fenetre Fenêtre de rognage.
+ */
+void remplir_rectangle(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre) {
+    remplir_boite(canvas, fenetre, rectangle.position.y, (long) rectangle.position.y + rectangle.height,
+                  rectangle.position.x, (long) rectangle.position.x + rectangle.width);
+}
+
+/**
+ * tracer_rectangle_epais - Trace le contour d'un rectangle avec un crayon épais.
+ *
+ * Chaque côté est épaissi perpendiculairement de (epaisseur - 1) / 2
+ * pixels vers l'intérieur et de epaisseur / 2 vers l'extérieur, comme
+ * les segments épais, et les coins sont pleins. Le contour est tracé en
+ * quatre blocs (haut, bas, gauche, droite) remplis par plages; si les
+ * côtés se rejoignent, le rectangle épaissi est rempli en entier.
+ *
+ * @param rectangle Structure contenant les paramètres du rectangle à tracer.
+ * @param canvas Pointeur vers le canevas sur lequel le rectangle sera tracé.
+ * @param fenetre Fenêtre de rognage.
+ * @param epaisseur Épaisseur des côtés, supérieure à 1.
+ */
+void tracer_rectangle_epais(Rectangle rectangle, struct canvas *canvas, const Fenetre *fenetre,
+                            unsigned int epaisseur) {
+    long avant = (epaisseur - 1) / 2, apres = epaisseur / 2;
+    long haut = rectangle.position.y, bas = (long) rectangle.position.y + rectangle.height - 1;
+    long gauche = rectangle.position.x, droite = (long) rectangle.position.x + rectangle.width - 1;
+
+    if (rectangle.height == 0 || rectangle.width == 0) return;
+
+    // Rectangle épaissi, puis intérieur laissé intact
+    long rangee_debut = haut - apres, rangee_fin = bas + apres + 1;
+    long colonne_debut = gauche - apres, colonne_fin = droite + apres + 1;
+    long trou_haut = haut + avant + 1, trou_bas = bas - avant;
+    long trou_gauche = gauche + avant + 1, trou_droite = droite - avant;
+
+    if (trou_haut >= trou_bas || trou_gauche >= trou_droite) {
+        remplir_boite(canvas, fenetre, rangee_debut, rangee_fin, colonne_debut, colonne_fin);
+        return;
+    }
+    remplir_boite(canvas, fenetre, rangee_debut, trou_haut, colonne_debut, colonne_fin);
+    remplir_boite(canvas, fenetre, trou_bas, rangee_fin, colonne_debut, colonne_fin);
+    remplir_boite(canvas, fenetre, trou_haut, trou_bas, colonne_debut, trou_gauche);
+    remplir_boite(canvas, fenetre, trou_haut, trou_bas, trou_droite, colonne_fin);
+}
+
+/**
+ * ecarts_representables - Vérifie que les écarts entre deux points tiennent dans un int.
+ *
+ * Les formules fermées de tracer_segment multiplient entre eux les écarts
+ * en rangée et en colonne : elles restent dans un long long tant que
+ * chacun vaut au plus INT_MAX.
+ *
+ * @param point_a Premier point.
+ * @param point_b Second point.
+ * @return int 1 si les deux écarts valent au plus INT_MAX, 0 sinon.
+ */
+int ecarts_representables(Coordonnees point_a, Coordonnees point_b) {
+    return llabs((long long) point_b.x - point_a.x) <= INT_MAX
+           && llabs((long long) point_b.y - point_a.y) <= INT_MAX;
+}
+
+/**
+ * recuperer_parametres_segment - Extrait les paramètres d'un segment à partir 
+ * d'une chaîne de caractères.
+ *
+ * Analyse une chaîne contenant quatre valeurs numériques séparées par des virgules,
+ * représentant les coordonnées des points de début et de fin d'un segment.
+ * Utilise ces paramètres pour initialiser une structure Segment. Les
+ * extrémités dont l'écart ne tient pas dans un int sont refusées.
+ *
+ * @param parametres_str Chaîne contenant les paramètres du segment.
+ * @param segment Pointeur vers le segment initialisé avec les coordonnées parsées.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error recuperer_parametres_segment(char *parametres_str, Segment *segment) {
+    unsigned int indice_parametre_courant = 0;
+    *segment = (Segment) {0};
+
+    if (est_valeur_absente(parametres_str)) return ERR_MISSING_VALUE;
+
+    char *suite = NULL;
+    char *parametre_courant = strtok_r(parametres_str, ",", &suite);
+    while (parametre_courant != NULL && indice_parametre_courant < 4) {
+        int parametre_int = 0;
+        if (convertir_entier(parametre_courant, &parametre_int) != OK) return ERR_WITH_VALUE;
+        switch (indice_parametre_courant) {
+            case 0:
+                segment->pointA.x = parametre_int;
+                break;
+            case 1:
+                segment->pointA.y = parametre_int;
+                break;
+            case 2:
+                segment->pointB.x = parametre_int;
+                break;
+            case 3:
+                segment->pointB.y = parametre_int;
+                break;
+        }
+        indice_parametre_courant++;
+        parametre_courant = strtok_r(NULL, ",", &suite);
+    }
+
+    if (indice_parametre_courant != 4) return ERR_MISSING_VALUE;
+    if (!ecarts_representables(segment->pointA, segment->pointB)) return ERR_WITH_VALUE;
+    return OK;
+}
+
+/**
+ * division_plancher - Divise deux entiers en arrondissant vers moins l'infini.
+ *
+ * @param numerateur Numérateur, éventuellement négatif.
+ * @param denominateur Dénominateur strictement positif.
+ * @return long long Plus grand entier inférieur ou égal au quotient.
+ */
+long long division_plancher(long long numerateur, long long denominateur) {
+    long long quotient = numerateur / denominateur;
+    return quotient * denominateur > numerateur ? quotient - 1 : quotient;
+}
+
+/**
+ * premiere_rangee_atteignant - Retourne le premier pas en rangée qui atteint une colonne.
+ *
+ * Le tracé pas à pas de Bresenham passe à la rangée suivante dès que son
+ * terme d'erreur, dx(1+ny) - dy(1+nx) après nx pas en rangée et ny pas en
+ * colonne, atteint -dy/2 : la rangée nx (nx < dx) s'arrête au plus petit
+ * ny tel que 2dx(1+ny) >= dy(2nx+1). Elle atteint donc la colonne ny dès
+ * que dy(2nx+1) > 2dx ny.
+ *
+ * @param colonne Pas en colonne, entre 1 et dy.
+ * @param delta_x Nombre total de pas en rangée.
+ * @param delta_y Nombre total de pas en colonne, non nul.
+ * @return long long Premier pas en rangée dont le tracé atteint la colonne.
+ */
+long long premiere_rangee_atteignant(long long colonne, long long delta_x, long long delta_y) {
+    return division_plancher(2 * delta_x * colonne - delta_y, 2 * delta_y) + 1;
+}
+
+/**
+ * derniere_colonne_rangee - Retourne le dernier pas en colonne tracé sur une rangée.
+ *
+ * @param rangee Pas en rangée, entre 0 et dx.
+ * @param delta_x Nombre total de pas en rangée.
+ * @param delta_y Nombre total de pas en colonne.
+ * @return long long Pas en colonne où le tracé quitte la rangée.
+ */
+long long derniere_colonne_rangee(long long rangee, long long delta_x, long long delta_y) {
+    if (rangee >= delta_x) return delta_y;
+
+    long long colonne = (delta_y * (2 * rangee + 1) + 2 * delta_x - 1) / (2 * delta_x) - 1;
+    return colonne < 0 ? 0 : colonne;
+}
+
+/**
+ * premiere_colonne_rangee - Retourne le premier pas en colonne tracé sur une rangée.
+ *
+ * @param rangee Pas en rangée, entre 0 et dx.
+ * @param delta_x Nombre total de pas en rangée.
+ * @param delta_y Nombre total de pas en colonne.
+ * @param direction_x Sens du segment en rangée, qui fixe le seuil des pas diagonaux.
+ * @return long long Pas en colonne où le tracé arrive sur la rangée.
+ */
+long long premiere_colonne_rangee(long long rangee, long long delta_x, long long delta_y, int direction_x) {
+    if (rangee == 0) return 0;
+
+    // Dernière colonne de la rangée précédente, puis pas diagonal si l'erreur le permet
+    long long precedente = derniere_colonne_rangee(rangee - 1, delta_x, delta_y);
+    long long erreur = delta_x * (1 + precedente) - delta_y * rangee;
+    return precedente + (direction_x > 0 ? erreur <= 0 : erreur < 0);
+}
+
+/**
+ * tracer_segment - Trace un segment de droite entre deux points sur un canevas.
+ *
+ * Implémente l'algorithme de Bresenham pour tracer un segment efficacement.
+ * Le segment est d'abord rogné une seule fois contre la fenêtre : les
+ * rangées visibles sont calculées comme dans Liang-Barsky, puis resserrées
+ * aux rangées dont le tracé croise les colonnes visibles. Le tracé reprend
+ * ensuite au premier pixel visible, avec le terme d'erreur qu'il aurait
+ * atteint pas à pas, et s'arrête au dernier : la boucle écrit sans aucune
+ * vérification de bornes. Les produits dx * dy des formules fermées
+ * restent dans un long long tant que les écarts tiennent dans un int,
+ * ce que l'analyse, le chargement des programmes et l'interface publique
+ * vérifient avec ecarts_representables.
+ *
+ * @param segment Structure représentant les points de début et de fin.
+ * @param canvas Pointeur vers le canevas sur lequel le segment est tracé.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_segment(Segment segment, struct canvas *canvas, const Fenetre *fenetre) {
+    long long x0 = segment.pointA.x;
+    long long y0 = segment.pointA.y;
+    long long delta_x = llabs(segment.pointB.x - x0);
+    long long delta_y = llabs(segment.pointB.y - y0);
+    int direction_x = x0 < segment.pointB.x ? 1 : -1;
+    int direction_y = y0 < segment.pointB.y ? 1 : -1;
+    long long premier, dernier, colonne_min, colonne_max;
+
+    if (!rogner_pas(x0, direction_x, delta_x, fenetre->rangee_debut, fenetre->rangee_fin, &premier, &dernier)
+            || !rogner_pas(y0, direction_y, delta_y, fenetre->colonne_debut, fenetre->colonne_fin,
+                           &colonne_min, &colonne_max)) {
+        return;
+    }
+
+    // Rangées dont le tracé croise les colonnes visibles
+    if (colonne_min > 0) {
+        long long rangee = premiere_rangee_atteignant(colonne_min, delta_x, delta_y);
+        if (rangee > premier) premier = rangee;
+    }
+    if (colonne_max < delta_y) {
+        long long rangee = premiere_rangee_atteignant(colonne_max + 1, delta_x, delta_y);
+        if (premiere_colonne_rangee(rangee, delta_x, delta_y, direction_x) > colonne_max) rangee--;
+        if (rangee < dernier) dernier = rangee;
+    }
+    if (premier > dernier) return;
+
+    // Premier et dernier pixels visibles, en pas depuis pointA
+    long long pas_x = premier;
+    long long pas_y = premiere_colonne_rangee(premier, delta_x, delta_y, direction_x);
+    if (pas_y < colonne_min) pas_y = colonne_min;
+    long long dernier_y = derniere_colonne_rangee(dernier, delta_x, delta_y);
+    if (dernier_y > colonne_max) dernier_y = colonne_max;
+
+    long long rangee = x0 + direction_x * pas_x;
+    long long colonne = y0 + direction_y * pas_y;
+    long long erreur = delta_x * (1 + pas_y) - delta_y * (1 + pas_x);
+
+    // Vers le haut, un pas diagonal peut se faire en deux : on compte donc les pixels écrits
+    unsigned long long ecrits = 0;
+
+    // Par rangées, on avance un pointeur de rangée plutôt que de recalculer l'adresse
+    char *pixels_rangee = canvas->tiled || canvas->packed || canvas->modifs != NULL
+                          ? NULL : pixel_canvas(canvas, rangee, 0);
+    long saut = direction_x * (long) canvas->stride;
+
+    while (1) {
+        if (pixels_rangee != NULL) pixels_rangee[colonne] = canvas->pen;
+        else placer_pixel(canvas, rangee, colonne);
+        ecrits++;
+
+        if (pas_x == dernier && pas_y == dernier_y) break;
+
+        long long erreur2 = 2 * erreur;
+
+        if (erreur2 >= -delta_y) {
+            erreur -= delta_y;
+            pas_x++;
+            rangee += direction_x;
+            if (pixels_rangee != NULL) pixels_rangee += saut;
+        }
+
+        if (erreur2 <= direction_x) {
+            erreur += delta_x;
+            pas_y++;
+            colonne += direction_y;
+        }
+    }
+    canvas->pixels_ecrits += ecrits;
+}
+
+/**
+ * tracer_segment_epais - Trace un segment de droite avec un crayon épais.
+ *
+ * Le segment épais est l'union des tracés de Bresenham du segment décalé
+ * de -(epaisseur - 1) / 2 à epaisseur / 2 pixels selon son axe
+ * secondaire, soit un parallélogramme aux bouts coupés droit. Chaque
+ * rangée visible en est une seule plage, dont les bornes viennent des
+ * formules fermées du tracé : le coût suit la surface écrite et non
+ * l'épaisseur multipliée par la longueur.
+ *
+ * @param segment Structure représentant les points de début et de fin.
+ * @param canvas Pointeur vers le canevas sur lequel le segment est tracé.
+ * @param fenetre Fenêtre de rognage.
+ * @param epaisseur Épaisseur du trait, supérieure à 1.
+ */
+void tracer_segment_epais(Segment segment, struct canvas *canvas, const Fenetre *fenetre,
+                          unsigned int epaisseur) {
+    long long x0 = segment.pointA.x;
+    long long y0 = segment.pointA.y;
+    long long delta_x = llabs(segment.pointB.x - x0);
+    long long delta_y = llabs(segment.pointB.y - y0);
+    int direction_x = x0 < segment.pointB.x ? 1 : -1;
+    int direction_y = y0 < segment.pointB.y ? 1 : -1;
+    long long avant = (epaisseur - 1) / 2, apres = epaisseur / 2;
+    int par_colonnes = delta_x >= delta_y;  // Axe principal en rangées : épaisseur en colonnes
+
+    // Rangées couvertes, épaissies seulement si l'axe secondaire est celui des rangées
+    long long rangee_debut = x0 < segment.pointB.x ? x0 : segment.pointB.x;
+    long long rangee_fin = rangee_debut + delta_x + 1;
+    if (!par_colonnes) {
+        rangee_debut -= avant;
+        rangee_fin += apres;
+    }
+    if (rangee_debut < fenetre->rangee_debut) rangee_debut = fenetre->rangee_debut;
+    if (rangee_fin > fenetre->rangee_fin) rangee_fin = fenetre->rangee_fin;
+
+    for (long long rangee = rangee_debut; rangee < rangee_fin; rangee++) {
+        // Pas en rangée du tracé d'origine que les copies décalées amènent ici
+        long long pas_debut = (rangee - x0) * direction_x, pas_fin = pas_debut;
+        if (!par_colonnes) {
+            long long pas1 = (rangee - apres - x0) * direction_x;
+            long long pas2 = (rangee + avant - x0) * direction_x;
+            pas_debut = pas1 < pas2 ? pas1 : pas2;
+            pas_fin = pas1 < pas2 ? pas2 : pas1;
+        }
+        if (pas_debut < 0) pas_debut = 0;
+        if (pas_fin > delta_x) pas_fin = delta_x;
+        if (pas_debut > pas_fin) continue;
+
+        long long colonne1 = y0 + direction_y * premiere_colonne_rangee(pas_debut, delta_x, delta_y, direction_x);
+        long long colonne2 = y0 + direction_y * derniere_colonne_rangee(pas_fin, delta_x, delta_y);
+        long long gauche = colonne1 < colonne2 ? colonne1 : colonne2;
+        long long droite = colonne1 < colonne2 ? colonne2 : colonne1;
+        if (par_colonnes) {
+            gauche -= avant;
+            droite += apres;
+        }
+        remplir_plage(canvas, fenetre, rangee, gauche, droite + 1);
+    }
+}
+
+/**
+ * recuperer_parametres_cercle - Extrait et valide les paramètres d'un cercle à partir d'une chaîne de caractères.
+ *
+ * Analyse une chaîne contenant trois valeurs numériques séparées par des virgules,
+ * représentant les coordonnées du centre et le rayon d'un cercle.  
+ *
+ * @param parametres_str Chaîne contenant les paramètres du cercle.
+ * @param cercle Pointeur vers le cercle initialisé avec les paramètres parsés.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error recuperer_parametres_cercle(char *parametres_str, Cercle *cercle) {
+    unsigned int indice_parametre_courant = 0;
+    *cercle = (Cercle) {0};
+
+    if (est_valeur_absente(parametres_str)) return ERR_MISSING_VALUE;
+
+    char *suite = NULL;
+    char *parametre_courant = strtok_r(parametres_str, ",", &suite);
+    while (parametre_courant != NULL && indice_parametre_courant < 3) {
+        int parametre_int = 0;
+        if (convertir_entier(parametre_courant, &parametre_int) != OK) return ERR_WITH_VALUE;
+        switch (indice_parametre_courant) {
+            case 0:
+                cercle->ROW = parametre_int;
+                break;
+            case 1:
+                cercle->COL = parametre_int;
+                break;
+            case 2:
+                cercle->rayon = parametre_int;
+                break;
+        }
+        
+        indice_parametre_courant++;
+        parametre_courant = strtok_r(NULL, ",", &suite);
+    }
+
+    if (est_negatif(cercle->rayon)) return ERR_WITH_VALUE;
+    if (indice_parametre_courant != 3) return ERR_MISSING_VALUE;
+    return OK;
+}
+
+/**
+ * racine_entiere - Calcule la racine carrée entière (par défaut) d'un entier.
+ *
+ * @param nombre Entier dont on cherche la racine.
+ * @return unsigned long long Plus grand r tel que r * r <= nombre.
+ */
+unsigned long long racine_entiere(unsigned long long nombre) {
+    unsigned long long racine = 0;
+    unsigned long long bit = 1ULL << 62;
+
+    while (bit > nombre) bit >>= 2;
+    while (bit != 0) {
+        if (nombre >= racine + bit) {
+            nombre -= racine + bit;
+            racine = (racine >> 1) + bit;
+        } else {
+            racine >>= 1;
+        }
+        bit >>= 2;
+    }
+    return racine;
+}
+
+/**
+ * racine_plafond - Calcule la racine carrée entière (par excès) d'un entier.
+ *
+ * @param nombre Entier dont on cherche la racine, éventuellement négatif.
+ * @return long long Plus petit r >= 0 tel que r * r >= nombre.
+ */
+long long racine_plafond(long long nombre) {
+    if (nombre <= 0) return 0;
+
+    long long racine = racine_entiere(nombre);
+    return racine * racine == nombre ? racine : racine + 1;
+}
+
+/**
+ * ordonnee_cercle - Retourne le y atteint par l'algorithme du point médian en x.
+ *
+ * Le terme de décision vaut 2(x+1)² + y² + (y-1)² - 2r² et y diminue dès
+ * qu'il est positif ou nul; le y courant en x est donc le plus grand y tel
+ * que y(y-1) <= r² - x² - 1.
+ *
+ * @param carre_rayon Carré du rayon.
+ * @param x Abscisse, au plus celle de la fin de l'octant.
+ * @return long long Ordonnée correspondante.
+ */
+long long ordonnee_cercle(long long carre_rayon, long long x) {
+    long long borne = carre_rayon - x * x - 1;
+    long long y = (1 + racine_entiere(1 + 4 * (unsigned long long) borne)) / 2;
+
+    while (y * (y - 1) > borne) y--;
+    while ((y + 1) * y <= borne) y++;
+    return y;
+}
+
+/**
+ * decision_cercle - Calcule le terme de décision du point médian en (x, y).
+ *
+ * Vaut 2(x+1)² + y² + (y-1)² - 2r², calculé sans former les carrés
+ * complets pour rester dans les limites d'un long long.
+ *
+ * @param rayon Rayon du cercle.
+ * @param x Abscisse courante.
+ * @param y Ordonnée courante.
+ * @return long long Terme de décision.
+ */
+long long decision_cercle(long long rayon, long long x, long long y) {
+    return 2 * ((x + 1) * (x + 1) - (rayon - y) * (rayon + y)) - 2 * y + 1;
+}
+
+/**
+ * avancer_point_median - Passe au pas suivant de l'algorithme du point médian.
+ *
+ * @param x Pointeur vers l'abscisse, augmentée de 1.
+ * @param y Pointeur vers l'ordonnée, diminuée de 1 si la décision est positive.
+ * @param decision Pointeur vers le terme de décision, mis à jour.
+ */
+void avancer_point_median(long long *x, long long *y, long long *decision) {
+    if (*decision < 0) {
+        *decision += 4 * *x + 6;
+    } else {
+        *decision += 4 * (*x - *y) + 10;
+        *y -= 1;
+    }
+    *x += 1;
+}
+
+/**
+ * fin_octant - Retourne le dernier x de l'octant parcouru par le point médian.
+ *
+ * L'octant (x <= y) se termine au plus grand x tel que 2x² - x + 1 <= r².
+ *
+ * @param carre_rayon Carré du rayon, non nul.
+ * @return long long Abscisse de la fin de l'octant.
+ */
+long long fin_octant(long long carre_rayon) {
+    long long x_fin = racine_entiere(carre_rayon / 2);
+
+    while (2 * x_fin * x_fin - x_fin + 1 > carre_rayon) x_fin--;
+    while (2 * (x_fin + 1) * (x_fin + 1) - x_fin <= carre_rayon) x_fin++;
+    return x_fin;
+}
+
+/**
+ * tracer_cercle_interieur - Trace un cercle entièrement compris dans la fenêtre.
+ *
+ * Parcourt l'octant pas à pas sans aucune vérification de bornes. Les
+ * quatre octants dont la rangée change à chaque pas reçoivent un pixel;
+ * les quatre autres accumulent leurs colonnes tant que y ne change pas,
+ * puis les tracent d'un seul coup avec remplir_rangee.
+ *
+ * @param x_centre Rangée du centre.
+ * @param y_centre Colonne du centre.
+ * @param rayon Rayon du cercle.
+ * @param canvas Pointeur vers le canevas sur lequel le cercle est tracé.
+ */
+void tracer_cercle_interieur(long x_centre, long y_centre, long long rayon, struct canvas *canvas) {
+    long long x = 0;
+    long long y = rayon;
+    long long decision = 3 - 2 * rayon;
+    long long debut = 0;
+
+    // Par rangées, on écrit directement les pixels plutôt que par placer_pixel
+    char *pixels = canvas->tiled || canvas->packed || canvas->modifs != NULL ? NULL : canvas->pixels;
+    size_t pas = canvas->stride;
+    char pen = canvas->pen;
+
+    while (x <= y) {
+        if (pixels != NULL) {
+            pixels[(x_centre + x) * pas + y_centre + y] = pen;
+            pixels[(x_centre - x) * pas + y_centre + y] = pen;
+            pixels[(x_centre + x) * pas + y_centre - y] = pen;
+            pixels[(x_centre - x) * pas + y_centre - y] = pen;
+        } else {
+            placer_pixel(canvas, x_centre + x, y_centre + y);
+            placer_pixel(canvas, x_centre - x, y_centre + y);
+            placer_pixel(canvas, x_centre + x, y_centre - y);
+            placer_pixel(canvas, x_centre - x, y_centre - y);
+        }
+
+        // Fin de la plage courante : y change au prochain pas, ou l'octant se termine
+        if (decision >= 0 || x + 1 > y) {
+            remplir_rangee(canvas, x_centre + y, y_centre + debut, y_centre + x + 1);
+            remplir_rangee(canvas, x_centre - y, y_centre + debut, y_centre + x + 1);
+            remplir_rangee(canvas, x_centre + y, y_centre - x, y_centre - debut + 1);
+            remplir_rangee(canvas, x_centre - y, y_centre - x, y_centre - debut + 1);
+            debut = x + 1;
+        }
+
+        avancer_point_median(&x, &y, &decision);
+    }
+    canvas->pixels_ecrits += 4 * x; // Quatre pixels isolés par pas, x pas au total
+}
+
+/**
+ * tracer_cercle - Trace un cercle sur un canevas en utilisant l'algorithme du point médian.
+ *
+ * Un cercle entièrement visible est tracé pas à pas sans vérification.
+ * Sinon, on obtient les mêmes pixels mais seules les rangées visibles
+ * sont parcourues : l'état de l'algorithme est calculé
+ * directement pour la première rangée visible, puis avance pas à pas.
+ * Pour les quatre octants dont la rangée change à chaque pas, chaque
+ * rangée reçoit un pixel de chaque côté du centre. Pour les quatre autres,
+ * chaque rangée reçoit une plage de colonnes de chaque côté.
+ *
+ * @param cercle Structure contenant les coordonnées du centre et le rayon du cercle.
+ * @param canvas Pointeur vers le canevas sur lequel le cercle sera tracé.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_cercle(Cercle cercle, struct canvas *canvas, const Fenetre *fenetre) {
+    long long rayon = cercle.rayon;
+    long long carre_rayon = rayon * rayon;
+    long long x_centre = cercle.ROW;
+    long long y_centre = cercle.COL;
+    long long premier, dernier;
+
+    // Boîte englobante hors de la fenêtre, ou entièrement dedans
+    if (x_centre + rayon < fenetre->rangee_debut || x_centre - rayon >= fenetre->rangee_fin
+            || y_centre + rayon < fenetre->colonne_debut || y_centre - rayon >= fenetre->colonne_fin) {
+        return;
+    }
+    if (x_centre - rayon >= fenetre->rangee_debut && x_centre + rayon < fenetre->rangee_fin
+            && y_centre - rayon >= fenetre->colonne_debut && y_centre + rayon < fenetre->colonne_fin) {
+        tracer_cercle_interieur(x_centre, y_centre, rayon, canvas);
+        return;
+    }
+
+    if (rayon == 0) {
+        if (rogner_pas(x_centre, 1, 0, fenetre->rangee_debut, fenetre->rangee_fin, &premier, &dernier)) {
+            remplir_plage(canvas, fenetre, x_centre, y_centre, y_centre + 1);
+        }
+        return;
+    }
+
+    long long x_fin = fin_octant(carre_rayon);
+    long long y_fin = ordonnee_cercle(carre_rayon, x_fin);
+
+    for (int sens = -1; sens <= 1; sens += 2) {
+        // Octants où x parcourt les rangées : un pixel de chaque côté par rangée
+        if (rogner_pas(x_centre, sens, x_fin, fenetre->rangee_debut, fenetre->rangee_fin,
+                       &premier, &dernier)) {
+            long long x = premier;
+            long long y = ordonnee_cercle(carre_rayon, x);
+            long long decision = decision_cercle(rayon, x, y);
+
+            while (x <= dernier) {
+                long rangee = x_centre + sens * x;
+                remplir_plage(canvas, fenetre, rangee, y_centre + y, y_centre + y + 1);
+                remplir_plage(canvas, fenetre, rangee, y_centre - y, y_centre - y + 1);
+                avancer_point_median(&x, &y, &decision);
+            }
+        }
+
+        // Octants où y parcourt les rangées : une plage de chaque côté par rangée
+        if (rogner_pas(x_centre + sens * y_fin, sens, rayon - y_fin, fenetre->rangee_debut,
+                       fenetre->rangee_fin, &premier, &dernier)) {
+            long long y = y_fin + dernier;
+            long long x = racine_plafond(carre_rayon - y * y - y);
+            long long decision = decision_cercle(rayon, x, y);
+            long long debut = x;
+
+            while (y >= y_fin + premier && x <= x_fin) {
+                if (decision >= 0 || x == x_fin) {
+                    long rangee = x_centre + sens * y;
+                    remplir_plage(canvas, fenetre, rangee, y_centre + debut, y_centre + x + 1);
+                    remplir_plage(canvas, fenetre, rangee, y_centre - x, y_centre - debut + 1);
+                    debut = x + 1;
+                }
+                avancer_point_median(&x, &y, &decision);
+            }
+        }
+    }
+}
+
+/**
+ * remplir_disque - Trace un disque plein sur un canevas.
+ *
+ * Suit le même parcours de l'algorithme du point médian que tracer_cercle,
+ * mais chaque rangée reçoit une seule plage allant d'un bord du cercle à
+ * l'autre plutôt que des points isolés, écrite une seule fois même pour la
+ * rangée du centre et celle où l'octant se termine : le disque couvre exactement le
+ * cercle de même rayon et son intérieur. Comme pour le cercle, seules les
+ * rangées visibles sont parcourues.
+ *
+ * @param cercle Structure contenant les coordonnées du centre et le rayon du disque.
+ * @param canvas Pointeur vers le canevas sur lequel le disque sera tracé.
+ * @param fenetre Fenêtre de rognage.
+ */
+void remplir_disque(Cercle cercle, struct canvas *canvas, const Fenetre *fenetre) {
+    long long rayon = cercle.rayon;
+    long long carre_rayon = rayon * rayon;
+    long long x_centre = cercle.ROW;
+    long long y_centre = cercle.COL;
+    long long premier, dernier;
+
+    if (x_centre + rayon < fenetre->rangee_debut || x_centre - rayon >= fenetre->rangee_fin
+            || y_centre + rayon < fenetre->colonne_debut || y_centre - rayon >= fenetre->colonne_fin) {
+        return;
+    }
+
+    if (rayon == 0) {
+        remplir_plage(canvas, fenetre, x_centre, y_centre, y_centre + 1);
+        return;
+    }
+
+    long long x_fin = fin_octant(carre_rayon);
+    long long y_fin = ordonnee_cercle(carre_rayon, x_fin);
+    // Si l'octant se termine sur la diagonale, sa rangée est déjà remplie par le parcours en x
+    long long y_debut = y_fin + (y_fin == x_fin);
+
+    for (int sens = -1; sens <= 1; sens += 2) {
+        // Rangées parcourues par x : la plage va de -y à y, la rangée du centre une seule fois
+        long long saut = sens > 0;
+
+        if (rogner_pas(x_centre + sens * saut, sens, x_fin - saut, fenetre->rangee_debut, fenetre->rangee_fin,
+                       &premier, &dernier)) {
+            long long x = saut + premier;
+            long long y = ordonnee_cercle(carre_rayon, x);
+            long long decision = decision_cercle(rayon, x, y);
+
+            while (x <= saut + dernier) {
+                remplir_plage(canvas, fenetre, x_centre + sens * x, y_centre - y, y_centre + y + 1);
+                avancer_point_median(&x, &y, &decision);
+            }
+        }
+
+        // Rangées parcourues par y : la plage va de -x à x, pour le dernier x de la rangée
+        if (rogner_pas(x_centre + sens * y_debut, sens, rayon - y_debut, fenetre->rangee_debut,
+                       fenetre->rangee_fin, &premier, &dernier)) {
+            long long y = y_debut + dernier;
+            long long x = racine_plafond(carre_rayon - y * y - y);
+            long long decision = decision_cercle(rayon, x, y);
+
+            while (y >= y_debut + premier && x <= x_fin) {
+                if (decision >= 0 || x == x_fin) {
+                    remplir_plage(canvas, fenetre, x_centre + sens * y, y_centre - x, y_centre + x + 1);
+                }
+                avancer_point_median(&x, &y, &decision);
+            }
+        }
+    }
+}
+
+/**
+ * demi_largeur_disque - Retourne la demi-largeur d'une rangée d'un disque plein.
+ *
+ * Donne directement la plage que remplir_disque trace à la distance d du
+ * centre : y(d) dans les rangées parcourues par x, et sinon le dernier
+ * x de l'octant dont l'ordonnée atteint d, soit le plus grand x tel que
+ * x² <= r² - 1 - d(d - 1).
+ *
+ * @param carre_rayon Carré du rayon, non nul.
+ * @param x_fin Fin de l'octant, donnée par fin_octant.
+ * @param distance Distance en rangées au centre, au plus le rayon.
+ * @return long long Nombre de colonnes couvertes de chaque côté du centre.
+ */
+long long demi_largeur_disque(long long carre_rayon, long long x_fin, long long distance) {
+    if (distance <= x_fin) return ordonnee_cercle(carre_rayon, distance);
+
+    long long x = racine_entiere(carre_rayon - 1 - distance * (distance - 1));
+    return x < x_fin ? x : x_fin;
+}
+
+/**
+ * tracer_cercle_epais - Trace un cercle avec un crayon épais.
+ *
+ * Le cercle épais est un anneau : le disque de rayon r + epaisseur / 2
+ * privé du disque de rayon r - (epaisseur - 1) / 2 - 1, tous deux tracés
+ * comme par remplir_disque. Chaque rangée visible reçoit une plage, ou
+ * deux si elle traverse le trou, dont les bornes sont calculées
+ * directement : le coût suit la surface de l'anneau.
+ *
+ * @param cercle Structure contenant les coordonnées du centre et le rayon du cercle.
+ * @param canvas Pointeur vers le canevas sur lequel le cercle sera tracé.
+ * @param fenetre Fenêtre de rognage.
+ * @param epaisseur Épaisseur du trait, supérieure à 1.
+ */
+void tracer_cercle_epais(Cercle cercle, struct canvas *canvas, const Fenetre *fenetre, unsigned int epaisseur) {
+    long long exterieur = (long long) cercle.rayon + epaisseur / 2;
+    long long trou = (long long) cercle.rayon - (epaisseur - 1) / 2 - 1;
+    long long x_centre = cercle.ROW;
+    long long y_centre = cercle.COL;
+
+    if (exterieur > INT_MAX) exterieur = INT_MAX;
+    long long carre_exterieur = exterieur * exterieur, carre_trou = trou * trou;
+    long long fin_exterieur = fin_octant(carre_exterieur);
+    long long fin_trou = trou > 0 ? fin_octant(carre_trou) : 0;
+
+    long long rangee_debut = x_centre - exterieur, rangee_fin = x_centre + exterieur + 1;
+    if (rangee_debut < fenetre->rangee_debut) rangee_debut = fenetre->rangee_debut;
+    if (rangee_fin > fenetre->rangee_fin) rangee_fin = fenetre->rangee_fin;
+
+    for (long long rangee = rangee_debut; rangee < rangee_fin; rangee++) {
+        long long distance = llabs(rangee - x_centre);
+        long long largeur = demi_largeur_disque(carre_exterieur, fin_exterieur, distance);
+
+        if (distance > trou) {
+            remplir_plage(canvas, fenetre, rangee, y_centre - largeur, y_centre + largeur + 1);
+            continue;
+        }
+        long long interieur = trou > 0 ? demi_largeur_disque(carre_trou, fin_trou, distance) : 0;
+        remplir_plage(canvas, fenetre, rangee, y_centre - largeur, y_centre - interieur);
+        remplir_plage(canvas, fenetre, rangee, y_centre + interieur + 1, y_centre + largeur + 1);
+    }
+}
+
+/**
+ * recuperer_germe - Extrait le point de départ d'un remplissage.
+ *
+ * Analyse une chaîne de la forme ROW,COL. Comme pour -h et -v, les
+ * valeurs négatives sont refusées; le point doit de plus se trouver
+ * dans le canevas, ce qui est vérifié au tracé.
+ *
+ * @param parametres_str Chaîne contenant la rangée et la colonne.
+ * @param germe Pointeur vers le point initialisé, x étant la rangée.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error recuperer_germe(char *parametres_str, Coordonnees *germe) {
+    int parametres[2] = {0};
+    unsigned int indice_parametre_courant = 0;
+
+    if (est_valeur_absente(parametres_str)) return ERR_MISSING_VALUE;
+
+    char *suite = NULL;
+    char *parametre_courant = strtok_r(parametres_str, ",", &suite);
+    while (parametre_courant != NULL && indice_parametre_courant < 2) {
+        if (convertir_entier(parametre_courant, &parametres[indice_parametre_courant]) != OK) {
+            return ERR_WITH_VALUE;
+        }
+        indice_parametre_courant++;
+        parametre_courant = strtok_r(NULL, ",", &suite);
+    }
+
+    if (indice_parametre_courant != 2) return ERR_MISSING_VALUE;
+    if (parametres[0] < 0 || parametres[1] < 0) return ERR_WITH_VALUE;
+    *germe = (Coordonnees) {parametres[0], parametres[1]};
+    return OK;
+}
+
+/**
+ * empiler_germe - Ajoute une plage à examiner au sommet de la pile.
+ *
+ * @param pile Pointeur vers la pile, agrandie au besoin.
+ * @param plage Plage à ajouter.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si la pile ne peut grandir.
+ */
+enum error empiler_germe(PileGermes *pile, PlageGerme plage) {
+    if (pile->nombre == pile->capacite) {
+        size_t capacite = pile->capacite == 0 ? CAPACITE_INITIALE_GERMES : pile->capacite * 2;
+        PlageGerme *plages = realloc(pile->plages, capacite * sizeof(PlageGerme));
+
+        if (plages == NULL) return ERR_OUT_OF_MEMORY;
+        pile->plages = plages;
+        pile->capacite = capacite;
+    }
+    pile->plages[pile->nombre++] = plage;
+    return OK;
+}
+
+/**
+ * remplir_zone - Remplit avec le crayon la zone de même couleur autour d'un point.
+ *
+ * La zone est formée des pixels de la couleur du point de départ qui lui
+ * sont reliés par des voisins horizontaux ou verticaux. L'algorithme,
+ * celui du remplissage par plages de Smith et Heckbert, n'est pas
+ * récursif : une pile explicite retient des plages de colonnes dont la
+ * rangée voisine reste à examiner. Chaque plage dépilée est prolongée
+ * vers la gauche, puis balayée vers la droite; chaque suite de pixels de
+ * la zone rencontrée est écrite d'un coup par remplir_rangee, et seule
+ * la partie qui déborde de la plage d'origine est renvoyée vers la
+ * rangée d'où elle vient. Un pixel écrit prend la couleur du crayon et
+ * ne fait donc plus partie de la zone : aucun pixel n'est écrit deux
+ * fois et la mémoire occupée croît avec le nombre de plages en attente,
+ * jamais avec la profondeur d'une récursion. La zone n'est pas rognée à
+ * une fenêtre : le remplissage s'applique toujours au canevas entier.
+ *
+ * @param germe Point de départ, compris dans le canevas, x étant la rangée.
+ * @param canvas Pointeur vers le canevas, dont toutes les rangées sont décodées.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si la pile ne peut grandir;
+ * la zone est alors partiellement remplie.
+ */
+enum error remplir_zone(Coordonnees germe, struct canvas *canvas) {
+    long hauteur = canvas->height, largeur = canvas->width;
+    char cible = lire_pixel(canvas, germe.x, germe.y);
+    PileGermes pile = {0};
+    enum error erreur = OK;
+
+    if (cible == canvas->pen) return OK;
+
+    erreur = empiler_germe(&pile, (PlageGerme) {germe.x, germe.y, germe.y, 1});
+    if (erreur == OK) erreur = empiler_germe(&pile, (PlageGerme) {germe.x - 1, germe.y, germe.y, -1});
+    while (erreur == OK && pile.nombre > 0) {
+        PlageGerme plage = pile.plages[--pile.nombre];
+        long rangee = plage.rangee;
+        long colonne = plage.colonne_debut;
+        long debut = colonne;
+
+        if (rangee < 0 || rangee >= hauteur) continue;
+
+        // Prolongement vers la gauche; le surplomb est renvoyé vers la rangée d'origine
+        if (lire_pixel(canvas, rangee, colonne) == cible) {
+            while (debut > 0 && lire_pixel(canvas, rangee, debut - 1) == cible) debut--;
+            if (debut < colonne) {
+                erreur = empiler_germe(&pile, (PlageGerme) {rangee - plage.sens, debut, colonne - 1, -plage.sens});
+            }
+        }
+
+        while (erreur == OK && colonne <= plage.colonne_fin) {
+            while (colonne < largeur && lire_pixel(canvas, rangee, colonne) == cible) colonne++;
+            if (colonne > debut) {
+                remplir_rangee(canvas, rangee, debut, colonne);
+                erreur = empiler_germe(&pile, (PlageGerme) {rangee + plage.sens, debut, colonne - 1, plage.sens});
+                if (erreur == OK && colonne - 1 > plage.colonne_fin) {
+                    erreur = empiler_germe(&pile, (PlageGerme) {rangee - plage.sens, plage.colonne_fin + 1,
+                                                                colonne - 1, -plage.sens});
+                }
+            }
+
+            // Saut des pixels d'une autre couleur jusqu'à la suite suivante de la plage
+            colonne++;
+            while (colonne < plage.colonne_fin && lire_pixel(canvas, rangee, colonne) != cible) colonne++;
+            debut = colonne;
+        }
+    }
+    free(pile.plages);
+    return erreur;
+}
+
+/**
+ * cotes_representables - Vérifie que chaque côté d'une ligne brisée peut être tracé.
+ *
+ * @param polygone Pointeur vers les sommets.
+ * @param fermee 1 pour vérifier aussi le côté qui revient au premier sommet.
+ * @return int 1 si les écarts de chaque côté tiennent dans un int, 0 sinon.
+ */
+int cotes_representables(const Polygone *polygone, int fermee) {
+    for (unsigned int i = 1; i < polygone->nombre; i++) {
+        if (!ecarts_representables(polygone->sommets[i - 1], polygone->sommets[i])) return 0;
+    }
+    return !fermee || ecarts_representables(polygone->sommets[polygone->nombre - 1], polygone->sommets[0]);
+}
+
+/**
+ * recuperer_sommets - Extrait les sommets d'une ligne brisée ou d'un polygone.
+ *
+ * Analyse une chaîne de la forme ROW1,COL1,ROW2,COL2,... et alloue le
+ * tableau des sommets, que liberer_commande libère. Comme pour -l, les
+ * sommets peuvent se trouver hors du canevas.
+ *
+ * @param parametres_str Chaîne contenant les coordonnées des sommets.
+ * @param minimum Nombre minimal de sommets.
+ * @param polygone Pointeur vers le polygone initialisé, vide en cas d'erreur.
+ * @return enum error OK, ERR_MISSING_VALUE, ERR_WITH_VALUE ou ERR_OUT_OF_MEMORY.
+ */
+enum error recuperer_sommets(char *parametres_str, unsigned int minimum, Polygone *polygone) {
+    Coordonnees *sommets = NULL;
+    size_t nombre_valeurs = 0, capacite = 0;
+    enum error erreur = OK;
+
+    *polygone = (Polygone) {NULL, 0};
+    if (est_valeur_absente(parametres_str)) return ERR_MISSING_VALUE;
+
+    char *suite = NULL;
+    char *parametre_courant = strtok_r(parametres_str, ",", &suite);
+    while (parametre_courant != NULL) {
+        int valeur = 0;
+
+        if (convertir_entier(parametre_courant, &valeur) != OK) {
+            erreur = ERR_WITH_VALUE;
+            break;
+        }
+        if (nombre_valeurs / 2 == capacite) {
+            size_t nouvelle_capacite = capacite == 0 ? 8 : capacite * 2;
+            Coordonnees *agrandi = realloc(sommets, nouvelle_capacite * sizeof(Coordonnees));
+
+            if (agrandi == NULL) {
+                erreur = ERR_OUT_OF_MEMORY;
+                break;
+            }
+            sommets = agrandi;
+            capacite = nouvelle_capacite;
+        }
+        if (nombre_valeurs % 2 == 0) sommets[nombre_valeurs / 2].x = valeur;
+        else sommets[nombre_valeurs / 2].y = valeur;
+        nombre_valeurs++;
+        parametre_courant = strtok_r(NULL, ",", &suite);
+    }
+
+    if (erreur == OK && (nombre_valeurs % 2 != 0 || nombre_valeurs / 2 < minimum)) erreur = ERR_MISSING_VALUE;
+    if (erreur != OK) {
+        free(sommets);
+        return erreur;
+    }
+    *polygone = (Polygone) {sommets, (unsigned int) (nombre_valeurs / 2)};
+    return OK;
+}
+
+/**
+ * tracer_ligne_brisee - Trace les côtés successifs d'une ligne brisée ou d'un polygone.
+ *
+ * Chaque côté est un segment de Bresenham tracé par tracer_segment, ou
+ * par tracer_segment_epais pour un crayon épais, exactement comme -l;
+ * un polygone est refermé par le côté qui relie son dernier sommet au
+ * premier.
+ *
+ * @param polygone Sommets de la ligne brisée.
+ * @param fermee 1 pour refermer le polygone, 0 pour une ligne brisée.
+ * @param epaisseur Épaisseur des côtés, 0 ou 1 pour un trait d'un pixel.
+ * @param canvas Pointeur vers le canevas.
+ * @param fenetre Fenêtre de rognage.
+ */
+void tracer_ligne_brisee(Polygone polygone, int fermee, unsigned int epaisseur,
+                         struct canvas *canvas, const Fenetre *fenetre) {
+    unsigned int nombre_cotes = fermee ? polygone.nombre : polygone.nombre - 1;
+
+    for (unsigned int i = 0; i < nombre_cotes; i++) {
+        Segment cote = {polygone.sommets[i], polygone.sommets[(i + 1) % polygone.nombre]};
+
+        if (epaisseur > 1) tracer_segment_epais(cote, canvas, fenetre, epaisseur);
+        else tracer_segment(cote, canvas, fenetre);
+    }
+}
+
+/**
+ * comparer_aretes - Ordonne deux arêtes selon leur première rangée, pour qsort.
+ *
+ * @param a Pointeur vers la première arête.
+ * @param b Pointeur vers la seconde arête.
+ * @return int Négatif, nul ou positif, comme strcmp.
+ */
+int comparer_aretes(const void *a, const void *b) {
+    const AretePolygone *arete_a = a, *arete_b = b;
+    return (arete_a->rangee_debut > arete_b->rangee_debut) - (arete_a->rangee_debut < arete_b->rangee_debut);
+}
+
+/**
+ * placer_arete - Calcule directement la colonne coupée par une arête à une rangée.
+ *
+ * Les k rangées parcourues depuis le sommet du haut ajoutent k fois la
+ * pente; k étant inférieur à la hauteur de l'arête, ni k * pas ni
+ * k * pas_reste ne dépassent un long long non signé.
+ *
+ * @param arete Pointeur vers l'arête, encore au sommet du haut.
+ * @param rangee Rangée visée, entre rangee_debut et rangee_fin.
+ */
+void placer_arete(AretePolygone *arete, long long rangee) {
+    unsigned long long pas_parcourus = rangee - arete->rangee_debut;
+    unsigned long long fraction = pas_parcourus * arete->pas_reste;
+
+    arete->colonne += (long long) pas_parcourus * arete->pas + (long long) (fraction / arete->hauteur);
+    arete->reste = fraction % arete->hauteur;
+}
+
+/**
+ * precede_arete - Indique si une arête coupe la rangée courante avant une autre.
+ *
+ * @param a Pointeur vers la première arête.
+ * @param b Pointeur vers la seconde arête.
+ * @return int 1 si la colonne coupée par a est inférieure à celle de b.
+ */
+int precede_arete(const AretePolygone *a, const AretePolygone *b) {
+    if (a->colonne != b->colonne) return a->colonne < b->colonne;
+    return a->reste * b->hauteur < b->reste * a->hauteur;
+}
+
+/**
+ * remplir_polygone - Trace un polygone plein par balayage des rangées.
+ *
+ * Les arêtes non horizontales sont triées par première rangée (table des
+ * arêtes), puis chaque rangée visible met à jour la liste des arêtes
+ * actives : celles qui commencent y entrent, celles qui finissent en
+ * sortent, et les autres avancent d'une rangée selon leur pente, en
+ * arithmétique entière exacte. La liste reste presque triée d'une rangée
+ * à l'autre, si bien qu'un tri par insertion la remet en ordre; chaque
+ * paire d'arêtes délimite alors une plage écrite par remplir_rangee
+ * (règle pair-impair). Le coût suit le nombre de rangées visibles et la
+ * surface écrite, même pour un polygone concave. Le contour, tracé ensuite
+ * comme par -P avec un trait d'un pixel, ajoute les pixels des bords que
+ * le balayage ne couvre pas, de sorte que le polygone plein recouvre son
+ * contour, comme -R et -C.
+ *
+ * @param polygone Sommets du polygone, au moins trois.
+ * @param canvas Pointeur vers le canevas.
+ * @param fenetre Fenêtre de rognage.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si la table des arêtes
+ * n'a pu être allouée.
+ */
+enum error remplir_polygone(Polygone polygone, struct canvas *canvas, const Fenetre *fenetre) {
+    AretePolygone *aretes = malloc(polygone.nombre * sizeof(AretePolygone));
+    AretePolygone **actives = malloc(polygone.nombre * sizeof(AretePolygone *));
+    size_t nombre_aretes = 0, nombre_actives = 0, suivante = 0;
+    long long rangee_debut = LLONG_MAX, rangee_fin = LLONG_MIN;
+
+    if (aretes == NULL || actives == NULL) {
+        free(aretes);
+        free(actives);
+        return ERR_OUT_OF_MEMORY;
+    }
+
+    // Table des arêtes, orientées du haut vers le bas
+    for (unsigned int i = 0; i < polygone.nombre; i++) {
+        Coordonnees a = polygone.sommets[i], b = polygone.sommets[(i + 1) % polygone.nombre];
+        if (a.x == b.x) continue;
+
+        Coordonnees haut = a.x < b.x ? a : b, bas = a.x < b.x ? b : a;
+        AretePolygone *arete = &aretes[nombre_aretes++];
+        long long largeur = (long long) bas.y - haut.y;
+
+        arete->rangee_debut = haut.x;
+        arete->rangee_fin = bas.x;
+        arete->hauteur = (long long) bas.x - haut.x;
+        arete->pas = division_plancher(largeur, arete->hauteur);
+        arete->pas_reste = largeur - arete->pas * (long long) arete->hauteur;
+        arete->colonne = haut.y;
+        arete->reste = 0;
+        if (arete->rangee_debut < rangee_debut) rangee_debut = arete->rangee_debut;
+        if (arete->rangee_fin > rangee_fin) rangee_fin = arete->rangee_fin;
+    }
+    qsort(aretes, nombre_aretes, sizeof(AretePolygone), comparer_aretes);
+    if (rangee_debut < fenetre->rangee_debut) rangee_debut = fenetre->rangee_debut;
+    if (rangee_fin > fenetre->rangee_fin) rangee_fin = fenetre->rangee_fin;
+
+    for (long long rangee = rangee_debut; rangee < rangee_fin; rangee++) {
+        // Arêtes qui commencent à cette rangée, ou au-dessus de la fenêtre
+        while (suivante < nombre_aretes && aretes[suivante].rangee_debut <= rangee) {
+            AretePolygone *arete = &aretes[suivante++];
+            if (arete->rangee_fin <= rangee) continue;
+            placer_arete(arete, rangee);
+            actives[nombre_actives++] = arete;
+        }
+
+        // Retrait des arêtes terminées, puis tri par insertion selon la colonne coupée
+        size_t gardees = 0;
+        for (size_t i = 0; i < nombre_actives; i++) {
+            if (actives[i]->rangee_fin > rangee) actives[gardees++] = actives[i];
+        }
+        nombre_actives = gardees;
+        for (size_t i = 1; i < nombre_actives; i++) {
+            AretePolygone *arete = actives[i];
+            size_t j = i;
+            while (j > 0 && precede_arete(arete, actives[j - 1])) {
+                actives[j] = actives[j - 1];
+                j--;
+            }
+            actives[j] = arete;
+        }
+
+        // Colonnes dont le centre est entre deux arêtes, bornes comprises
+        for (size_t i = 0; i + 1 < nombre_actives; i += 2) {
+            long long gauche = actives[i]->colonne + (actives[i]->reste > 0);
+            long long droite = actives[i + 1]->colonne;
+            if (gauche <= droite) remplir_plage(canvas, fenetre, rangee, gauche, droite + 1);
+        }
+
+        for (size_t i = 0; i < nombre_actives; i++) {
+            AretePolygone *arete = actives[i];
+            arete->colonne += arete->pas;
+            arete->reste += arete->pas_reste;
+            if (arete->reste >= arete->hauteur) {
+                arete->reste -= arete->hauteur;
+                arete->colonne++;
+            }
+        }
+    }
+    free(aretes);
+    free(actives);
+
+    tracer_ligne_brisee(polygone, 1, 1, canvas, fenetre);
+    return OK;
+}
+
+/**
+ * choisir_couleur - Sélectionne et valide la première caractère de la chaîne
+ * couleur comme couleur valide.
+ *
+ * Convertit la chaîne de couleur en entier et vérifie si elle se situe
+ * entre 0 et 7.
+ *
+ * @param couleur Chaîne de caractères représentant la couleur.
+ * @param crayon Pointeur vers le premier caractère de la chaîne de couleur validée.
+ * @return enum error OK, ERR_MISSING_VALUE ou ERR_WITH_VALUE.
+ */
+enum error choisir_couleur(char *couleur, char *crayon) {
+    int couleur_int = 0;
+
+    if (est_valeur_absente(couleur)) return ERR_MISSING_VALUE;
+    if (convertir_entier(couleur, &couleur_int) != OK) return ERR_WITH_VALUE;
+    if (couleur_int < 0 || couleur_int > 7) return ERR_WITH_VALUE;
+    *crayon = couleur[0];
+    return OK;
+}
+
+/**
+ * definir_couleur_fond - Définit la couleur de fond du terminal selon la couleur spécifiée.
+ *
+ * Utilise les codes d'échappement ANSI pour changer la couleur de fond du terminal.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param couleur Index de la couleur à appliquer au fond, ajouté de
+ * 40 pour obtenir le code de fond correct.
+ */
+void definir_couleur_fond(TamponSortie *sortie, int couleur) {
+    char sequence[] = "\033[40m";
+    sequence[3] = '0' + couleur;
+    ajouter_octets(sortie, sequence, sizeof(sequence) - 1);
+}
+
+/**
+ * reinitialiser_couleur - Réinitialise la couleur de fond du terminal 
+ * à sa valeur par défaut.
+ *
+ * Utilise les codes d'échappement ANSI pour réinitialiser 
+ * toutes les décorations du terminal.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ */
+void reinitialiser_couleur(TamponSortie *sortie) {
+    ajouter_octets(sortie, "\033[0m", sizeof("\033[0m") - 1);
+}
+
+/**
+ * couleur_pixel - Retourne la couleur ANSI associée à un pixel.
+ *
+ * @param pixel Caractère du pixel ('.' ou '0' à '7').
+ * @return int Index de couleur entre 0 et 7, ou COULEUR_DEFAUT pour '.'.
+ */
+int couleur_pixel(char pixel) {
+    if (pixel >= '0' && pixel <= '7') return pixel - '0';
+    return COULEUR_DEFAUT;
+}
+
+/**
+ * ecrire_pixels_couleur - Encode des pixels consécutifs en plages de couleur ANSI.
+ *
+ * Regroupe les pixels consécutifs de même couleur en une plage d'espaces
+ * précédée d'une seule séquence d'échappement, émise uniquement lorsque la
+ * couleur change. Les pixels débutent et se terminent dans la couleur par
+ * défaut du terminal, ce qui donne le même rendu qu'une séquence par pixel.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param rangee Premier pixel à encoder.
+ * @param largeur Nombre de pixels à encoder.
+ */
+void ecrire_pixels_couleur(TamponSortie *sortie, const char *rangee, unsigned int largeur) {
+    int couleur_courante = COULEUR_DEFAUT;
+    unsigned int debut = 0;
+
+    while (debut < largeur) {
+        unsigned int fin = debut + 1;
+        while (fin < largeur && rangee[fin] == rangee[debut]) fin++;
+
+        int couleur = couleur_pixel(rangee[debut]);
+        if (couleur != couleur_courante) {
+            if (couleur == COULEUR_DEFAUT) reinitialiser_couleur(sortie);
+            else definir_couleur_fond(sortie, couleur);
+            couleur_courante = couleur;
+        }
+        ajouter_repetition(sortie, ' ', fin - debut);
+        debut = fin;
+    }
+    if (couleur_courante != COULEUR_DEFAUT) reinitialiser_couleur(sortie);
+}
+
+/**
+ * ecrire_rangee_couleur - Encode une rangée en plages de couleur ANSI.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param rangee Pixels de la rangée.
+ * @param largeur Nombre de pixels de la rangée.
+ */
+void ecrire_rangee_couleur(TamponSortie *sortie, const char *rangee, unsigned int largeur) {
+    ecrire_pixels_couleur(sortie, rangee, largeur);
+    ajouter_octet(sortie, '\n');
+}
+
+/**
+ * imprimer_canvas_couleur - Affiche un canevas avec la gestion des couleurs.
+ *
+ * Encode chaque rangée en plages de couleur : les pixels représentés par des
+ * chiffres ('0' à '7') reçoivent la couleur de fond ANSI correspondante et
+ * les pixels '.' la couleur par défaut. La sortie est formatée dans un
+ * tampon transmis au flux par gros blocs.
+ *
+ * @param canvas Pointeur vers le canevas à imprimer.
+ * @param flux Flux de destination, stdout pour la ligne de commande.
+ * @return size_t Nombre d'octets écrits sur le flux.
+ */
+size_t imprimer_canvas_couleur(struct canvas *canvas, FILE *flux) {
+    char zone[TAILLE_TAMPON_SORTIE];
+    TamponSortie sortie;
+
+    initialiser_tampon_sortie(&sortie, zone, sizeof(zone), flux);
+    for (unsigned int i = 0; i < canvas->height; i++) {
+        ecrire_rangee_couleur(&sortie, lire_rangee(canvas, i, canvas->rangee_lue), canvas->width);
+    }
+    vider_tampon_sortie(&sortie);
+    return sortie.octets_ecrits;
+}
+
+/**
+ * taille_max_rangee - Borne le nombre d'octets formatés pour une rangée.
+ *
+ * Au pire, avec -k, chaque pixel change de couleur et reçoit sa propre
+ * séquence d'échappement, la plus longue étant "\033[4Xm".
+ *
+ * @param canvas Pointeur vers le canevas à formater.
+ * @param couleur Encodage en couleurs ANSI plutôt qu'en texte brut.
+ * @return size_t Nombre maximal d'octets, retour à la ligne compris.
+ */
+size_t taille_max_rangee(const struct canvas *canvas, int couleur) {
+    if (!couleur) return (size_t) canvas->width + 1;
+    return (size_t) canvas->width * (sizeof("\033[40m") - 1 + 1) + sizeof("\033[0m") - 1 + 1;
+}
+
+/**
+ * formater_tranche - Point d'entrée d'un thread de formatage de la sortie.
+ *
+ * Formate les rangées de la tranche dans sa zone privée avec les mêmes
+ * routines que l'impression séquentielle. La zone est dimensionnée par
+ * taille_max_rangee : le tampon n'est jamais plein et n'a pas de flux.
+ *
+ * @param argument Pointeur vers la TrancheSortie à formater.
+ * @return void* Toujours NULL.
+ */
+void *formater_tranche(void *argument) {
+    TrancheSortie *tranche = argument;
+    const struct canvas *canvas = tranche->canvas;
+    TamponSortie sortie;
+
+    initialiser_tampon_sortie(&sortie, tranche->zone, tranche->capacite, NULL);
+    for (unsigned int i = tranche->rangee_debut; i < tranche->rangee_fin; i++) {
+        const char *rangee = lire_rangee(canvas, i, tranche->tampon);
+
+        if (tranche->couleur) {
+            ecrire_rangee_couleur(&sortie, rangee, canvas->width);
+        } else {
+            ajouter_octets(&sortie, rangee, canvas->width);
+            ajouter_octet(&sortie, '\n');
+        }
+    }
+    tranche->taille = sortie.taille;
+    return NULL;
+}
+
+/**
+ * imprimer_canvas_parallele - Affiche un canevas en formatant avec plusieurs threads.
+ *
+ * À chaque tour, les threads formatent des tranches de rangées
+ * consécutives et disjointes, d'environ TAILLE_TRANCHE_SORTIE octets,
+ * dans des zones privées; le thread appelant écrit ensuite les zones
+ * dans l'ordre des rangées. La sortie est identique, octet pour octet,
+ * à celle de imprimer_canvas ou de imprimer_canvas_couleur, vers
+ * lesquelles l'impression se replie si les zones ne peuvent être allouées.
+ *
+ * @param canvas Pointeur vers le canevas à imprimer.
+ * @param flux Flux de destination, stdout pour la ligne de commande.
+ * @param couleur Encodage en couleurs ANSI (-k) plutôt qu'en texte brut.
+ * @param nombre_threads Nombre de threads de formatage.
+ * @return size_t Nombre d'octets écrits sur le flux.
+ */
+size_t imprimer_canvas_parallele(struct canvas *canvas, FILE *flux, int couleur,
+                                 unsigned int nombre_threads) {
+    TrancheSortie tranches[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int demarre[MAX_THREADS];
+    size_t taille_rangee = taille_max_rangee(canvas, couleur);
+    size_t rangees_par_tranche = TAILLE_TRANCHE_SORTIE / taille_rangee;
+    size_t octets_ecrits = 0;
+
+    if (rangees_par_tranche == 0) rangees_par_tranche = 1;
+    size_t nombre_tranches = (canvas->height + rangees_par_tranche - 1) / rangees_par_tranche;
+    if (nombre_threads > nombre_tranches) nombre_threads = nombre_tranches;
+
+    int allouees = 1;
+    for (unsigned int t = 0; t < nombre_threads; t++) {
+        tranches[t].canvas = canvas;
+        tranches[t].couleur = couleur;
+        tranches[t].capacite = rangees_par_tranche * taille_rangee;
+        tranches[t].zone = malloc(tranches[t].capacite);
+        tranches[t].tampon = canvas->rangee_lue != NULL ? malloc((size_t) canvas->width + 1) : NULL;
+        if (tranches[t].zone == NULL || (canvas->rangee_lue != NULL && tranches[t].tampon == NULL)) allouees = 0;
+    }
+    if (!allouees) {
+        for (unsigned int t = 0; t < nombre_threads; t++) {
+            free(tranches[t].zone);
+            free(tranches[t].tampon);
+        }
+        return couleur ? imprimer_canvas_couleur(canvas, flux) : imprimer_canvas(canvas, flux);
+    }
+
+    unsigned int rangee = 0;
+    while (rangee < canvas->height) {
+        unsigned int nombre_tour = 0;
+
+        for (; nombre_tour < nombre_threads && rangee < canvas->height; nombre_tour++) {
+            tranches[nombre_tour].rangee_debut = rangee;
+            rangee = canvas->height - rangee > rangees_par_tranche ? rangee + rangees_par_tranche
+                                                                   : canvas->height;
+            tranches[nombre_tour].rangee_fin = rangee;
+        }
+        for (unsigned int t = 1; t < nombre_tour; t++) {
+            demarre[t] = pthread_create(&threads[t], NULL, formater_tranche, &tranches[t]) == 0;
+        }
+        formater_tranche(&tranches[0]);
+        for (unsigned int t = 1; t < nombre_tour; t++) {
+            if (demarre[t]) pthread_join(threads[t], NULL);
+            else formater_tranche(&tranches[t]);
+        }
+        for (unsigned int t = 0; t < nombre_tour; t++) {
+            octets_ecrits += fwrite(tranches[t].zone, 1, tranches[t].taille, flux);
+        }
+    }
+
+    for (unsigned int t = 0; t < nombre_threads; t++) {
+        free(tranches[t].zone);
+        free(tranches[t].tampon);
+    }
+    return octets_ecrits;
+}
+
+/**
+ * suivre_modifications - Active le suivi des pixels modifiés d'un canevas.
+ *
+ * Toutes les rangées sont d'abord considérées comme modifiées, pour que
+ * la première image dessine le canevas en entier.
+ *
+ * @param canvas Pointeur vers le canevas à suivre.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY.
+ */
+enum error suivre_modifications(struct canvas *canvas) {
+    canvas->modifs = malloc(((size_t) canvas->height + 1) * sizeof(PlageModifiee));
+    if (canvas->modifs == NULL) return ERR_OUT_OF_MEMORY;
+
+    for (unsigned int i = 0; i < canvas->height; i++) {
+        canvas->modifs[i] = (PlageModifiee) {0, canvas->width};
+    }
+    return OK;
+}
+
+/**
+ * deplacer_curseur - Ajoute la séquence ANSI plaçant le curseur sur un pixel.
+ *
+ * @param sortie Pointeur vers le tampon de sortie.
+ * @param rangee Rangée du pixel, à partir de 0.
+ * @param colonne Colonne du pixel, à partir de 0.
+ */
+void deplacer_curseur(TamponSortie *sortie, unsigned int rangee, unsigned int colonne) {
+    char sequence[sizeof("\033[4294967295;4294967295H")];
+    int longueur = snprintf(sequence, sizeof(sequence), "\033[%u;%uH", rangee + 1, colonne + 1);
+
+    ajouter_octets(sortie, sequence, longueur);
+}
+
+/**
+ * imprimer_modifications - Réaffiche les pixels modifiés depuis l'image précédente.
+ *
+ * Pour chaque rangée modifiée, place le curseur au début de la plage
+ * modifiée et n'écrit que cette plage, en texte brut ou en couleurs ANSI,
+ * puis oublie la modification. La taille de la sortie est donc
+ * proportionnelle aux modifications plutôt qu'au canevas. Le curseur est
+ * enfin placé sous le canevas.
+ *
+ * @param canvas Pointeur vers le canevas dont les modifications sont suivies.
+ * @param flux Flux de destination, un terminal en pratique.
+ * @param couleur Encodage en couleurs ANSI (-k) plutôt qu'en texte brut.
+ * @param premiere Efface d'abord l'écran s'il s'agit de la première image.
+ * @return size_t Nombre d'octets écrits sur le flux.
+ */
+size_t imprimer_modifications(struct canvas *canvas, FILE *flux, int couleur, int premiere) {
+    char zone[TAILLE_TAMPON_SORTIE];
+    TamponSortie sortie;
+
+    initialiser_tampon_sortie(&sortie, zone, sizeof(zone), flux);
+    if (premiere) ajouter_octets(&sortie, "\033[2J", sizeof("\033[2J") - 1);
+    for (unsigned int i = 0; i < canvas->height; i++) {
+        PlageModifiee *plage = &canvas->modifs[i];
+        if (plage->debut == plage->fin) continue;
+
+        const char *pixels = lire_rangee(canvas, i, canvas->rangee_lue) + plage->debut;
+        deplacer_curseur(&sortie, i, plage->debut);
+        if (couleur) ecrire_pixels_couleur(&sortie, pixels, plage->fin - plage->debut);
+        else ajouter_octets(&sortie, pixels, plage->fin - plage->debut);
+        plage->debut = plage->fin = 0;
+    }
+    deplacer_curseur(&sortie, canvas->height, 0);
+    vider_tampon_sortie(&sortie);
+    return sortie.octets_ecrits;
+}
+
+/**
+ * analyser_commande - Traduit une option de dessin et sa valeur en commande.
+ *
+ * Valide la syntaxe de la valeur (présence, nombre de paramètres, valeurs
+ * numériques, dimensions positives, écarts des segments et des côtés qui
+ * tiennent dans un int) sans toucher au canevas et sans
+ * terminer le programme, ce qui permet de l'utiliser aussi bien pour la
+ * ligne de commande que pour les scripts et le serveur.
+ *
+ * @param option Option de dessin (-p, -w, -h, -v, -r, -l, -c, -R, -C, -F, -L, -P ou -A).
+ * @param valeur Valeur de l'option, éventuellement NULL.
+ * @param commande Pointeur vers la commande à remplir, dont les sommets
+ * de -L, -P et -A sont à libérer avec liberer_commande.
+ * @return enum error OK, ERR_MISSING_VALUE, ERR_WITH_VALUE, ou
+ * ERR_OUT_OF_MEMORY, ou ERR_UNRECOGNIZED_OPTION si l'option n'est pas
+ * une option de dessin.
+ */
+enum error analyser_commande(char *option, char *valeur, Commande *commande) {
+    commande->option = option;
+
+    if (strcmp(option, "-p") == 0) {
+        commande->type = COMMANDE_CRAYON;
+        return choisir_couleur(valeur, &commande->parametres.crayon);
+    } else if (strcmp(option, "-w") == 0) {
+        commande->type = COMMANDE_EPAISSEUR;
+        return recuperer_epaisseur(valeur, &commande->parametres.epaisseur);
+    } else if (strcmp(option, "-h") == 0) {
+        commande->type = COMMANDE_HORIZONTALE;
+        return recuperer_indice(valeur, &commande->parametres.indice);
+    } else if (strcmp(option, "-v") == 0) {
+        commande->type = COMMANDE_VERTICALE;
+        return recuperer_indice(valeur, &commande->parametres.indice);
+    } else if (strcmp(option, "-r") == 0) {
+        commande->type = COMMANDE_RECTANGLE;
+        return recuperer_parametres_rectangle(valeur, &commande->parametres.rectangle);
+    } else if (strcmp(option, "-l") == 0) {
+        commande->type = COMMANDE_SEGMENT;
+        return recuperer_parametres_segment(valeur, &commande->parametres.segment);
+    } else if (strcmp(option, "-c") == 0) {
+        commande->type = COMMANDE_CERCLE;
+        return recuperer_parametres_cercle(valeur, &commande->parametres.cercle);
+    } else if (strcmp(option, "-R") == 0) {
+        commande->type = COMMANDE_RECTANGLE_PLEIN;
+        return recuperer_parametres_rectangle(valeur, &commande->parametres.rectangle);
+    } else if (strcmp(option, "-C") == 0) {
+        commande->type = COMMANDE_DISQUE;
+        return recuperer_parametres_cercle(valeur, &commande->parametres.cercle);
+    } else if (strcmp(option, "-F") == 0) {
+        commande->type = COMMANDE_REMPLISSAGE;
+        return recuperer_germe(valeur, &commande->parametres.germe);
+    } else if (strcmp(option, "-L") == 0 || strcmp(option, "-P") == 0 || strcmp(option, "-A") == 0) {
+        commande->type = option[1] == 'L' ? COMMANDE_POLYLIGNE
+                         : option[1] == 'P' ? COMMANDE_POLYGONE : COMMANDE_POLYGONE_PLEIN;
+        enum error erreur = recuperer_sommets(valeur, commande->type == COMMANDE_POLYLIGNE ? 2 : 3,
+                                              &commande->parametres.polygone);
+        if (erreur == OK && !cotes_representables(&commande->parametres.polygone,
+                                                  commande->type != COMMANDE_POLYLIGNE)) {
+            liberer_commande(commande);
+            erreur = ERR_WITH_VALUE;
+        }
+        return erreur;
+    }
+    return ERR_UNRECOGNIZED_OPTION;
+}
+
+/**
+ * verifier_commande - Vérifie les valeurs d'une commande qui dépendent du canevas.
+ *
+ * @param canvas Pointeur vers le canevas auquel la commande est destinée.
+ * @param commande Pointeur vers la commande à vérifier.
+ * @return enum error OK, ou ERR_WITH_VALUE si la rangée, la colonne ou
+ * le point de départ d'un remplissage est hors du canevas.
+ */
+enum error verifier_commande(const struct canvas *canvas, const Commande *commande) {
+    const Coordonnees *germe = &commande->parametres.germe;
+
+    if (commande->type == COMMANDE_HORIZONTALE && commande->parametres.indice >= canvas->height) {
+        return ERR_WITH_VALUE;
+    }
+    if (commande->type == COMMANDE_VERTICALE && commande->parametres.indice >= canvas->width) {
+        return ERR_WITH_VALUE;
+    }
+    if (commande->type == COMMANDE_REMPLISSAGE
+            && ((unsigned int) germe->x >= canvas->height || (unsigned int) germe->y >= canvas->width)) {
+        return ERR_WITH_VALUE;
+    }
+    return OK;
+}
+
+/**
+ * decoder_rangees_commande - Décode les rangées RLE qu'une commande peut toucher.
+ *
+ * Les rangées couvertes par la commande, rognées à la fenêtre, sont
+ * décodées avant le tracé : une ligne horizontale n'en décode qu'une,
+ * une ligne verticale ou un remplissage toutes celles de la fenêtre. Les
+ * contours tracés avec un crayon épais débordent de epaisseur / 2 rangées.
+ *
+ * @param canvas Pointeur vers le canevas, qui a une source RLE.
+ * @param commande Pointeur vers la commande, déjà vérifiée.
+ * @param fenetre Fenêtre de rognage.
+ */
+void decoder_rangees_commande(struct canvas *canvas, const Commande *commande, const Fenetre *fenetre) {
+    long long debut = fenetre->rangee_debut, fin = fenetre->rangee_fin;
+    long long debord = canvas->epaisseur > 1 ? canvas->epaisseur / 2 : 0;
+    const Rectangle *rectangle = &commande->parametres.rectangle;
+    const Segment *segment = &commande->parametres.segment;
+    const Cercle *cercle = &commande->parametres.cercle;
+    const Polygone *polygone = &commande->parametres.polygone;
+
+    switch (commande->type) {
+        case COMMANDE_HORIZONTALE:
+            debut = commande->parametres.indice;
+            fin = debut + 1;
+            break;
+        case COMMANDE_VERTICALE:
+        case COMMANDE_REMPLISSAGE:
+            break;
+        case COMMANDE_RECTANGLE:
+            debut = (long long) rectangle->position.y - debord;
+            fin = (long long) rectangle->position.y + rectangle->height + debord;
+            break;
+        case COMMANDE_RECTANGLE_PLEIN:
+            debut = rectangle->position.y;
+            fin = debut + rectangle->height;
+            break;
+        case COMMANDE_SEGMENT:
+            debut = (segment->pointA.x < segment->pointB.x ? segment->pointA.x : segment->pointB.x) - debord;
+            fin = (segment->pointA.x < segment->pointB.x ? segment->pointB.x : segment->pointA.x) + 1LL + debord;
+            break;
+        case COMMANDE_CERCLE:
+            debut = (long long) cercle->ROW - cercle->rayon - debord;
+            fin = (long long) cercle->ROW + cercle->rayon + 1 + debord;
+            break;
+        case COMMANDE_DISQUE:
+            debut = (long long) cercle->ROW - cercle->rayon;
+            fin = (long long) cercle->ROW + cercle->rayon + 1;
+            break;
+        case COMMANDE_POLYLIGNE:
+        case COMMANDE_POLYGONE:
+        case COMMANDE_POLYGONE_PLEIN:
+            debut = LLONG_MAX;
+            fin = LLONG_MIN;
+            for (unsigned int i = 0; i < polygone->nombre; i++) {
+                if (polygone->sommets[i].x < debut) debut = polygone->sommets[i].x;
+                if (polygone->sommets[i].x + 1LL > fin) fin = polygone->sommets[i].x + 1LL;
+            }
+            if (commande->type != COMMANDE_POLYGONE_PLEIN) {
+                debut -= debord;
+                fin += debord;
+            }
+            break;
+        default:
+            return;
+    }
+    if (debut < fenetre->rangee_debut) debut = fenetre->rangee_debut;
+    if (fin > fenetre->rangee_fin) fin = fenetre->rangee_fin;
+    decoder_rangees(canvas, debut, fin);
+}
+
+/**
+ * appliquer_commande - Trace une commande vérifiée, rognée à une fenêtre.
+ *
+ * Seuls les pixels de la fenêtre sont modifiés, ce qui permet à plusieurs
+ * threads de rejouer les mêmes commandes sur des bandes disjointes. Le
+ * remplissage fait exception : il suit sa zone dans tout le canevas et
+ * ne doit être appliqué qu'avec la fenêtre du canevas entier. Les
+ * rangées RLE touchées sont d'abord décodées. Les contours (-r, -l, -c)
+ * sont tracés épais si l'épaisseur courante dépasse 1. Avec --stats, la commande
+ * et ses pixels écrits sont comptés selon son type.
+ *
+ * @param canvas Pointeur vers le canevas à modifier.
+ * @param commande Pointeur vers la commande, déjà vérifiée.
+ * @param fenetre Fenêtre de rognage.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si un remplissage ou un
+ * polygone plein n'a pu être terminé.
+ */
+enum error appliquer_commande(struct canvas *canvas, const Commande *commande, const Fenetre *fenetre) {
+    unsigned long long pixels_avant = canvas->pixels_ecrits;
+    enum error erreur = OK;
+
+    if (canvas->rle != NULL) decoder_rangees_commande(canvas, commande, fenetre);
+    switch (commande->type) {
+        case COMMANDE_CRAYON:
+            canvas->pen = commande->parametres.crayon;
+            break;
+        case COMMANDE_EPAISSEUR:
+            canvas->epaisseur = commande->parametres.epaisseur;
+            break;
+        case COMMANDE_HORIZONTALE:
+            tracer_ligne_horizontale(canvas, fenetre, commande->parametres.indice);
+            break;
+        case COMMANDE_VERTICALE:
+            tracer_ligne_verticale(canvas, fenetre, commande->parametres.indice);
+            break;
+        case COMMANDE_RECTANGLE:
+            if (canvas->epaisseur > 1) {
+                tracer_rectangle_epais(commande->parametres.rectangle, canvas, fenetre, canvas->epaisseur);
+            } else {
+                tracer_rectangle(commande->parametres.rectangle, canvas, fenetre);
+            }
+            break;
+        case COMMANDE_SEGMENT:
+            if (canvas->epaisseur > 1) {
+                tracer_segment_epais(commande->parametres.segment, canvas, fenetre, canvas->epaisseur);
+            } else {
+                tracer_segment(commande->parametres.segment, canvas, fenetre);
+            }
+            break;
+        case COMMANDE_CERCLE:
+            if (canvas->epaisseur > 1) {
+                tracer_cercle_epais(commande->parametres.cercle, canvas, fenetre, canvas->epaisseur);
+            } else {
+                tracer_cercle(commande->parametres.cercle, canvas, fenetre);
+            }
+            break;
+        case COMMANDE_RECTANGLE_PLEIN:
+            remplir_rectangle(commande->parametres.rectangle, canvas, fenetre);
+            break;
+        case COMMANDE_DISQUE:
+            remplir_disque(commande->parametres.cercle, canvas, fenetre);
+            break;
+        case COMMANDE_REMPLISSAGE:
+            erreur = remplir_zone(commande->parametres.germe, canvas);
+            break;
+        case COMMANDE_POLYLIGNE:
+        case COMMANDE_POLYGONE:
+            tracer_ligne_brisee(commande->parametres.polygone, commande->type == COMMANDE_POLYGONE,
+                                canvas->epaisseur, canvas, fenetre);
+            break;
+        case COMMANDE_POLYGONE_PLEIN:
+            erreur = remplir_polygone(commande->parametres.polygone, canvas, fenetre);
+            break;
+        case COMMANDE_AFFICHAGE:
+            break; // Émise par executer_script
+        case COMMANDE_SCRIPT:
+        case COMMANDE_PROGRAMME:
+            break; // Appliqués par executer_commandes
+    }
+    if (canvas->compteurs != NULL && commande->type < COMMANDE_SCRIPT) {
+        canvas->compteurs[commande->type].commandes++;
+        canvas->compteurs[commande->type].pixels += canvas->pixels_ecrits - pixels_avant;
+    }
+    return erreur;
+}
+
+/**
+ * executer_commande - Applique une commande de dessin au canevas.
+ *
+ * Vérifie les valeurs qui dépendent des dimensions du canevas, puis
+ * appelle la routine de tracé correspondante.
+ *
+ * @param canvas Pointeur vers le canevas à modifier.
+ * @param commande Pointeur vers la commande à appliquer.
+ * @return enum error OK, ERR_WITH_VALUE si la rangée ou la colonne
+ * est hors du canevas, ou ERR_OUT_OF_MEMORY.
+ */
+enum error executer_commande(struct canvas *canvas, const Commande *commande) {
+    enum error erreur = verifier_commande(canvas, commande);
+    if (erreur != OK) return erreur;
+
+    Fenetre fenetre = fenetre_canvas(canvas);
+    return appliquer_commande(canvas, commande, &fenetre);
+}
+
+/**
+ * rendre_bande - Point d'entrée d'un thread de rendu par bandes.
+ *
+ * Rejoue dans l'ordre toutes les commandes du lot, rognées à la bande
+ * du thread. Le crayon et l'épaisseur sont propres à chaque bande et suivent donc, dans
+ * chacune, la même évolution qu'en exécution séquentielle.
+ *
+ * @param argument Pointeur vers la Bande à rendre.
+ * @return void* Toujours NULL.
+ */
+void *rendre_bande(void *argument) {
+    Bande *bande = argument;
+
+    bande->erreur = OK;
+    for (size_t i = 0; i < bande->nombre && bande->erreur == OK; i++) {
+        bande->erreur = appliquer_commande(&bande->canvas, &bande->commandes[i], &bande->fenetre);
+        bande->fautive = i;
+    }
+    return NULL;
+}
+
+/**
+ * rendre_par_bandes - Applique des commandes vérifiées avec plusieurs threads.
+ *
+ * Le canevas est découpé en bandes de rangées disjointes, une par thread,
+ * et chaque thread rejoue toutes les commandes rognées à sa bande : aucun
+ * pixel n'est partagé entre deux threads et l'ordre des commandes est
+ * préservé dans chaque bande. Une bande dont le thread n'a pas pu être
+ * créé est rendue par le thread appelant. Une bande s'arrête à sa
+ * première erreur de tracé, qui ne peut être qu'un manque de mémoire.
+ *
+ * @param canvas Pointeur vers le canevas à modifier.
+ * @param commandes Commandes vérifiées, sans remplissage ni script.
+ * @param nombre Nombre de commandes.
+ * @param nombre_threads Nombre de threads demandé.
+ * @param fautive Reçoit l'indice de la première commande en erreur.
+ * @return enum error OK, ou ERR_OUT_OF_MEMORY si une bande n'a pu être terminée.
+ */
+enum error rendre_par_bandes(struct canvas *canvas, const Commande *commandes, size_t nombre,
+                             unsigned int nombre_threads, size_t *fautive) {
+    Bande bandes[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int demarre[MAX_THREADS];
+    Fenetre fenetre = fenetre_canvas(canvas);
+    unsigned int nombre_bandes = nombre_threads < canvas->height ? nombre_threads : canvas->height;
+    enum error erreur = OK;
+
+    if (nombre == 0) return OK;
+    if (nombre_bandes == 0) nombre_bandes = 1;
+
+    for (unsigned int b = 0; b < nombre_bandes; b++) {
+        bandes[b].canvas = *canvas;
+        bandes[b].fenetre = fenetre;
+        bandes[b].fenetre.rangee_debut = (long) ((size_t) canvas->height * b / nombre_bandes);
+        bandes[b].fenetre.rangee_fin = (long) ((size_t) canvas->height * (b + 1) / nombre_bandes);
+        bandes[b].commandes = commandes;
+        bandes[b].nombre = nombre;
+        memset(bandes[b].compteurs, 0, sizeof(bandes[b].compteurs));
+        if (canvas->compteurs != NULL) bandes[b].canvas.compteurs = bandes[b].compteurs;
+    }
+    for (unsigned int b = 1; b < nombre_bandes; b++) {
+        demarre[b] = pthread_create(&threads[b], NULL, rendre_bande, &bandes[b]) == 0;
+    }
+    rendre_bande(&bandes[0]);
+    for (unsigned int b = 1; b < nombre_bandes; b++) {
+        if (demarre[b]) pthread_join(threads[b], NULL);
+        else rendre_bande(&bandes[b]);
+    }
+    canvas->pen = bandes[0].canvas.pen;
+    canvas->epaisseur = bandes[0].canvas.epaisseur;
+
+    // Chaque bande a compté ses propres pixels; les commandes ne sont comptées qu'une fois
+    unsigned long long pixels_avant = canvas->pixels_ecrits;
+    for (unsigned int b = 0; b < nombre_bandes; b++) {
+        canvas->pixels_ecrits += bandes[b].canvas.pixels_ecrits - pixels_avant;
+        for (int type = 0; canvas->compteurs != NULL && type < COMMANDE_SCRIPT; type++) {
+            canvas->compteurs[type].pixels += bandes[b].compteurs[type].pixels;
+            if (b == 0) canvas->compteurs[type].commandes += bandes[b].compteurs[type].commandes;
+        }
+        if (bandes[b].erreur != OK && (erreur == OK || bandes[b].fautive < *fautive)) {
+            erreur = bandes[b].erreur;
+            *fautive = bandes[b].fautive;
+        }
+    }
+    return erreur;
+}
+
+/**
+ * executer_lot_parallele - Applique un lot de commandes avec plusieurs threads.
+ *
+ * Toutes les commandes sont d'abord vérifiées dans l'ordre : à la
+ * première valeur invalide, rien n'est tracé et l'indice de la commande
+ * fautive est retourné, comme l'exécution séquentielle l'aurait rencontrée.
+ * Les commandes sont ensuite rendues par bandes avec rendre_par_bandes,
+ * sauf les remplissages : une zone peut traverser toutes les bandes, si
+ * bien que chaque remplissage est appliqué seul, sur le canevas entier,
+ * entre les commandes qui le précèdent et celles qui le suivent.
+ *
+ * @param canvas Pointeur vers le canevas à modifier.
+ * @param commandes Commandes à appliquer, sans commande de script.
+ * @param nombre Nombre de commandes.
+ * @param nombre_threads Nombre de threads demandé.
+ * @param fautive Reçoit l'indice de la commande invalide en cas d'erreur.
+ * @return enum error OK, ERR_WITH_VALUE si une rangée ou une colonne
+ * est hors du canevas, ou ERR_OUT_OF_MEMORY si un remplissage ou un
+ * polygone plein n'a pu être terminé.
+ */
+enum error executer_lot_parallele(struct canvas *canvas, const Commande *commandes, size_t nombre,
+                                  unsigned int nombre_threads, size_t *fautive) {
+    Fenetre fenetre = fenetre_canvas(canvas);
+    size_t debut = 0;
+
+    for (size_t i = 0; i < nombre; i++) {
+        enum error erreur = verifier_commande(canvas, &commandes[i]);
+        if (erreur != OK) {
+            *fautive = i;
+            return erreur;
+        }
+    }
+
+    for (size_t i = 0; i < nombre; i++) {
+        if (commandes[i].type != COMMANDE_REMPLISSAGE) continue;
+        enum error erreur = rendre_par_bandes(canvas, commandes + debut, i - debut, nombre_threads, fautive);
+        if (erreur != OK) {
+            *fautive += debut;
+            return erreur;
+        }
+        erreur = appliquer_commande(canvas, &commandes[i], &fenetre);
+        if (erreur != OK) {
+            *fautive = i;
+            return erreur;
+        }
+        debut = i + 1;
+    }
+    enum error erreur = rendre_par_bandes(canvas, commandes + debut, nombre - debut, nombre_threads, fautive);
+    if (erreur != OK) *fautive += debut;
+    return erreur;
+}
+
+// Option correspondant à chaque type de commande
+char *const OPTIONS_COMMANDES[] = {
+    [COMMANDE_CRAYON]          = "-p",
+    [COMMANDE_HORIZONTALE]     = "-h",
+    [COMMANDE_VERTICALE]       = "-v",
+    [COMMANDE_RECTANGLE]       = "-r",
+    [COMMANDE_SEGMENT]         = "-l",
+    [COMMANDE_CERCLE]          = "-c",
+    [COMMANDE_RECTANGLE_PLEIN] = "-R",
+    [COMMANDE_DISQUE]          = "-C",
+    [COMMANDE_REMPLISSAGE]     = "-F",
+    [COMMANDE_EPAISSEUR]       = "-w",
+    [COMMANDE_POLYLIGNE]       = "-L",
+    [COMMANDE_POLYGONE]        = "-P",
+    [COMMANDE_POLYGONE_PLEIN]  = "-A",
+    [COMMANDE_AFFICHAGE]       = "-s",
+    [COMMANDE_SCRIPT]          = "-f",
+    [COMMANDE_PROGRAMME]       = "--run"
+};
+
+/**
+ * instructions_sommets - Retourne le nombre d'instructions qui suivent une commande.
+ *
+ * Les sommets d'une ligne brisée ou d'un polygone suivent son
+ * instruction, deux par instruction; les autres commandes tiennent
+ * dans une seule instruction.
+ *
+ * @param commande Pointeur vers la commande.
+ * @return size_t Nombre d'instructions de sommets.
+ */
+size_t instructions_sommets(const Commande *commande) {
+    switch (commande->type) {
+        case COMMANDE_POLYLIGNE:
+        case COMMANDE_POLYGONE:
+        case COMMANDE_POLYGONE_PLEIN:
+            return (commande->parametres.polygone.nombre + 1) / 2;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * coder_instruction - Traduit une commande analysée en instruction compilée.
+ *
+ * @param commande Pointeur vers la commande, ni script ni programme.
+ * @param instruction Pointeur vers l'instruction à remplir.
+ */
+void coder_instruction(const Commande *commande, Instruction *instruction) {
+    const Rectangle *rectangle = &commande->parametres.rectangle;
+    const Segment *segment = &commande->parametres.segment;
+    const Cercle *cercle = &commande->parametres.cercle;
+
+    memset(instruction, 0, sizeof(*instruction));
+    instruction->type = commande->type;
+    switch (commande->type) {
+        case COMMANDE_CRAYON:
+            instruction->crayon = commande->parametres.crayon;
+            break;
+        case COMMANDE_EPAISSEUR:
+            instruction->valeurs[0] = (int32_t) commande->parametres.epaisseur;
+            break;
+        case COMMANDE_HORIZONTALE:
+        case COMMANDE_VERTICALE:
+            instruction->valeurs[0] = (int32_t) commande->parametres.indice;
+            break;
+        case COMMANDE_RECTANGLE:
+        case COMMANDE_RECTANGLE_PLEIN:
+            instruction->valeurs[0] = rectangle->position.y;
+            instruction->valeurs[1] = rectangle->position.x;
+            instruction->valeurs[2] = (int32_t) rectangle->height;
+            instruction->valeurs[3] = (int32_t) rectangle->width;
+            break;
+        case COMMANDE_SEGMENT:
+            instruction->valeurs[0] = segment->pointA.x;
+            instruction->valeurs[1] = segment->pointA.y;
+            instruction->valeurs[2] = segment->pointB.x;
+            instruction->valeurs[3] = segment->pointB.y;
+            break;
+        case COMMANDE_CERCLE:
+        case COMMANDE_DISQUE:
+            instruction->valeurs[0] = cercle->ROW;
+            instruction->valeurs[1] = cercle->COL;
+            instruction->valeurs[2] = (int32_t) cercle->rayon;
+            break;
+        case COMMANDE_REMPLISSAGE:
+            instruction->valeurs[0] = commande->parametres.germe.x;
+            instruction->valeurs[1] = commande->parametres.germe.y;
+            break;
+        case COMMANDE_POLYLIGNE:
+        case COMMANDE_POLYGONE:
+        case COMMANDE_POLYGONE_PLEIN:
+            instruction->valeurs[0] = (int32_t) commande->parametres.polygone.nombre;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * coder_sommets - Traduit deux sommets d'une ligne brisée ou d'un polygone en instruction.
+ *
+ * @param commande Pointeur vers la commande.
+ * @param indice Indice de l'instruction de sommets, à partir de 0.
+ * @param instruction Pointeur vers l'instruction à remplir, du type de la commande.
+ */
+void coder_sommets(const Commande *commande, size_t indice, Instruction *instruction) {
+    const Polygone *polygone = &commande->parametres.polygone;
+
+    memset(instruction, 0, sizeof(*instruction));
+    instruction->type = commande->type;
+    for (size_t i = 2 * indice; i < 2 * indice + 2 && i < polygone->nombre; i++) {
+        instruction->valeurs[2 * (i - 2 * indice)] = polygone->sommets[i].x;
+        instruction->valeurs[2 * (i - 2 * indice) + 1] = polygone->sommets[i].y;
+    }
+}
+
+/**
+ * decoder_instruction - Traduit une instruction compilée en commande.
+ *
+ * Refait les vérifications de l'analyse qui ne dépendent pas du canevas
+ * (type connu, crayon de 0 à 7, épaisseur, dimensions et rayon
+ * strictement positifs, point de départ d'un remplissage positif, nombre
+ * de sommets), pour
+ * qu'un fichier altéré ne puisse rien tracer qu'une option n'aurait pas
+ * tracé. Le tableau des sommets d'une ligne brisée ou d'un polygone est
+ * alloué, vide, et rempli ensuite par decoder_sommets.
+ *
+ * @param instruction Pointeur vers l'instruction lue.
+ * @param commande Pointeur vers la commande à remplir.
+ * @param restantes Nombre d'instructions qui suivent dans le fichier.
+ * @return enum error OK, ERR_WITH_VALUE si l'instruction est invalide,
+ * ou ERR_OUT_OF_MEMORY.
+ */
+enum error decoder_instruction(const Instruction *instruction, Commande *commande, uint64_t restantes) {
+    const int32_t *valeurs = instruction->valeurs;
+
+    if (instruction->type > COMMANDE_AFFICHAGE) return ERR_WITH_VALUE;
+    commande->type = instruction->type;
+    commande->option = OPTIONS_COMMANDES[commande->type];
+    switch (commande->type) {
+        case COMMANDE_CRAYON:
+            if (instruction->crayon < '0' || instruction->crayon > '7') return ERR_WITH_VALUE;
+            commande->parametres.crayon = instruction->crayon;
+            break;
+        case COMMANDE_EPAISSEUR:
+            if (valeurs[0] <= 0) return ERR_WITH_VALUE;
+            commande->parametres.epaisseur = (unsigned int) valeurs[0];
+            break;
+        case COMMANDE_HORIZONTALE:
+        case COMMANDE_VERTICALE:
+            commande->parametres.indice = (unsigned int) valeurs[0];
+            break;
+        case COMMANDE_RECTANGLE:
+        case COMMANDE_RECTANGLE_PLEIN:
+            if (valeurs[2] <= 0 || valeurs[3] <= 0) return ERR_WITH_VALUE;
+            commande->parametres.rectangle = (Rectangle) {{valeurs[1], valeurs[0]}, valeurs[2], valeurs[3]};
+            break;
+        case COMMANDE_SEGMENT:
+            if (!ecarts_representables((Coordonnees) {valeurs[0], valeurs[1]},
+                                       (Coordonnees) {valeurs[2], valeurs[3]})) {
+                return ERR_WITH_VALUE;
+            }
+            commande->parametres.segment = (Segment) {{valeurs[0], valeurs[1]}, {valeurs[2], valeurs[3]}};
+            break;
+        case COMMANDE_CERCLE:
+        case COMMANDE_DISQUE:
+            if (valeurs[2] <= 0) return ERR_WITH_VALUE;
+            commande->parametres.cercle = (Cercle) {valeurs[0], valeurs[1], valeurs[2]};
+            break;
+        case COMMANDE_REMPLISSAGE:
+            if (valeurs[0] < 0 || valeurs[1] < 0) return ERR_WITH_VALUE;
+            commande->parametres.germe = (Coordonnees) {valeurs[0], valeurs[1]};
+            break;
+        case COMMANDE_POLYLIGNE:
+        case COMMANDE_POLYGONE:
+        case COMMANDE_POLYGONE_PLEIN:
+            commande->parametres.polygone = (Polygone) {NULL, 0};
+            if (valeurs[0] < (commande->type == COMMANDE_POLYLIGNE ? 2 : 3)
+                    || ((uint64_t) valeurs[0] + 1) / 2 > restantes) {
+                return ERR_WITH_VALUE;
+            }
+            commande->parametres.polygone.sommets = malloc(valeurs[0] * sizeof(Coordonnees));
+            if (commande->parametres.polygone.sommets == NULL) return ERR_OUT_OF_MEMORY;
+            commande->parametres.polygone.nombre = valeurs[0];
+            break;
+        default:
+            break;
+    }
+    return OK;
+}
+
+/**
+ * decoder_sommets - Recopie deux sommets d'une instruction dans une commande.
+ *
+ * @param instruction Pointeur vers l'instruction lue.
+ * @param commande Pointeur vers la ligne brisée ou le polygone en cours de lecture.
+ * @param indice Indice de l'instruction de sommets, à partir de 0.
+ * @return enum error OK, ou ERR_WITH_VALUE si l'instruction n'est pas
+ * du type de la commande.
+ */
+enum error decoder_sommets(const Instruction *instruction, Commande *commande, size_t indice) {
+    Polygone *polygone = &commande->parametres.polygone;
+
+    if (instruction->type != commande->type) return ERR_WITH_VALUE;
+    for (size_t i = 2 * indice; i < 2 * indice + 2 && i < polygone->nombre; i++) {
+        polygone->sommets[i].x = instruction->valeurs[2 * (i - 2 * indice)];
+        polygone->sommets[i].y = instruction->valeurs[2 * (i - 2 * indice) + 1];
+    }
+    // Une fois le dernier sommet lu, les côtés sont vérifiés comme à l'analyse
+    if (2 * indice + 2 >= polygone->nombre
+            && !cotes_representables(polygone, commande->type != COMMANDE_POLYLIGNE)) {
+        return ERR_WITH_VALUE;
+    }
+    return OK;
+}
+
+/**
+ * enregistrer_programme - Écrit une liste de commandes dans le format compilé.
+ *
+ * Chaque commande devient une instruction de taille fixe, aux entiers
+ * déjà convertis et validés, suivie de ses sommets pour une ligne brisée
+ * ou un polygone, le tout précédé d'une en-tête qui donne le nombre
+ * d'instructions. Les commandes ne peuvent être ni des scripts ni des programmes.
+ * Comme pour enregistrer_canvas_binaire, le programme est écrit dans un
+ * fichier temporaire qui ne remplace le fichier demandé qu'une fois
+ * complet : un échec laisse l'ancien programme intact.
+ *
+ * @param commandes Commandes à écrire.
+ * @param nombre Nombre de commandes.
+ * @param chemin Chemin du fichier, remplacé s'il existe.
+ * @return enum error OK, ERR_WITH_VALUE si le fichier ne peut être écrit,
+ * ou ERR_OUT_OF_MEMORY.
+ */
+enum error enregistrer_programme(const Commande *commandes, size_t nombre, const char *chemin) {
+    char *temporaire = malloc(strlen(chemin) + sizeof(".XXXXXX"));
+    EnteteProgramme entete = {.version = VERSION_PROGRAMME, .nombre = nombre};
+    Instruction instruction;
+
+    if (temporaire == NULL) return ERR_OUT_OF_MEMORY;
+    sprintf(temporaire, "%s.XXXXXX", chemin);
+
+    int descripteur = mkstemp(temporaire);
+    FILE *flux = descripteur < 0 ? NULL : fdopen(descripteur, "wb");
+    enum error erreur = flux == NULL ? ERR_WITH_VALUE : OK;
+
+    for (size_t i = 0; i < nombre; i++) entete.nombre += instructions_sommets(&commandes[i]);
+    memcpy(entete.magie, MAGIE_PROGRAMME, sizeof(entete.magie));
+    if (erreur == OK && fwrite(&entete, sizeof(entete), 1, flux) != 1) erreur = ERR_WITH_VALUE;
+    for (size_t i = 0; erreur == OK && i < nombre; i++) {
+        coder_instruction(&commandes[i], &instruction);
+        if (fwrite(&instruction, sizeof(instruction), 1, flux) != 1) erreur = ERR_WITH_VALUE;
+        for (size_t j = 0; erreur == OK && j < instructions_sommets(&commandes[i]); j++) {
+            coder_sommets(&commandes[i], j, &instruction);
+            if (fwrite(&instruction, sizeof(instruction), 1, flux) != 1) erreur = ERR_WITH_VALUE;
+        }
+    }
+    if (erreur == OK && fchmod(descripteur, 0644) != 0) erreur = ERR_WITH_VALUE;
+    if (flux != NULL && fclose(flux) != 0) erreur = ERR_WITH_VALUE;
+    else if (flux == NULL && descripteur >= 0) close(descripteur);
+    if (erreur == OK && rename(temporaire, chemin) != 0) erreur = ERR_WITH_VALUE;
+    if (erreur != OK && descripteur >= 0) unlink(temporaire);
+    free(temporaire);
+    return erreur;
+}
+
+/**
+ * liberer_programme - Libère les commandes d'un programme compilé.
+ *
+ * @param programme Pointeur vers le programme.
+ */
+void liberer_programme(Programme *programme) {
+    for (size_t i = 0; i < programme->nombre; i++) liberer_commande(&programme->commandes[i]);
+    free(programme->commandes);
+    programme->commandes = NULL;
+    programme->nombre = 0;
+}
+
+/**
+ * liberer_commande - Libère les données allouées avec une commande.
+ *
+ * Seuls les sommets des lignes brisées et des polygones, et les
+ * programmes chargés par --run, sont alloués; les autres commandes
+ * n'ont rien à libérer.
+ *
+ * @param commande Pointeur vers la commande.
+ */
+void liberer_commande(Commande *commande) {
+    switch (commande->type) {
+        case COMMANDE_POLYLIGNE:
+        case COMMANDE_POLYGONE:
+        case COMMANDE_POLYGONE_PLEIN:
+            free(commande->parametres.polygone.sommets);
+            commande->parametres.polygone = (Polygone) {NULL, 0};
+            break;
+        case COMMANDE_PROGRAMME:
+            liberer_programme(commande->parametres.programme);
+            free(commande->parametres.programme);
+            commande->parametres.programme = NULL;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * charger_programme - Lit un programme compilé.
+ *
+ * L'en-tête est vérifiée (signature, version, taille du fichier), puis
+ * les instructions sont lues par blocs de INSTRUCTIONS_PAR_LECTURE et
+ * décodées en commandes, prêtes à être rejouées sur autant de canevas
+ * qu'il le faut. Les instructions de sommets complètent la ligne brisée
+ * ou le polygone qui les précède, même d'un bloc à l'autre.
+ *
+ * @param programme Pointeur vers le programme à remplir.
+ * @param chemin Chemin du fichier.
+ * @return enum error OK, ERR_WITH_VALUE si le fichier est illisible ou
+ * invalide, ou ERR_OUT_OF_MEMORY.
+ */
+enum error charger_programme(Programme *programme, const char *chemin) {
+    FILE *flux = fopen(chemin, "rb");
+    EnteteProgramme entete;
+    struct stat etat;
+    enum error erreur = OK;
+
+    *programme = (Programme) {.chemin = chemin};
+    if (flux == NULL) return ERR_WITH_VALUE;
+    if (fstat(fileno(flux), &etat) != 0 || fread(&entete, sizeof(entete), 1, flux) != 1
+            || memcmp(entete.magie, MAGIE_PROGRAMME, sizeof(entete.magie)) != 0
+            || entete.version != VERSION_PROGRAMME
+            || entete.nombre != ((uint64_t) etat.st_size - sizeof(entete)) / sizeof(Instruction)
+            || ((uint64_t) etat.st_size - sizeof(entete)) % sizeof(Instruction) != 0) {
+        fclose(flux);
+        return ERR_WITH_VALUE;
+    }
+
+    Instruction *instructions = malloc(INSTRUCTIONS_PAR_LECTURE * sizeof(Instruction));
+    uint64_t decodees = 0;
+    size_t sommets_attendus = 0;   // Instructions de sommets de la dernière commande encore à lire
+
+    programme->commandes = malloc((entete.nombre ? entete.nombre : 1) * sizeof(Commande));
+    if (instructions == NULL || programme->commandes == NULL) erreur = ERR_OUT_OF_MEMORY;
+    while (erreur == OK && decodees < entete.nombre) {
+        size_t lues = fread(instructions, sizeof(Instruction), INSTRUCTIONS_PAR_LECTURE, flux);
+
+        if (lues == 0) erreur = ERR_WITH_VALUE;
+        for (size_t i = 0; erreur == OK && i < lues && decodees < entete.nombre; i++, decodees++) {
+            if (sommets_attendus > 0) {
+                Commande *commande = &programme->commandes[programme->nombre - 1];
+                erreur = decoder_sommets(&instructions[i], commande,
+                                         instructions_sommets(commande) - sommets_attendus--);
+            } else {
+                Commande *commande = &programme->commandes[programme->nombre];
+                erreur = decoder_instruction(&instructions[i], commande, entete.nombre - decodees - 1);
+                if (erreur == OK) {
+                    programme->nombre++;
+                    sommets_attendus = instructions_sommets(commande);
+                }
+            }
+        }
+    }
+    free(instructions);
+    fclose(flux);
+    if (erreur != OK) liberer_programme(programme);
+    return erreur;
+}
+
+/**
+ * publier_canvas - Remet au programme appelant un canevas alloué par l'interface publique.
+ *
+ * @param canvas Canevas alloué, libéré en cas d'erreur.
+ * @param erreur Résultat de son initialisation.
+ * @param resultat Reçoit le canevas, ou NULL en cas d'erreur.
+ * @return enum error La même erreur.
+ */
+enum error publier_canvas(struct canvas *canvas, enum error erreur, struct canvas **resultat) {
+    if (erreur != OK) {
+        liberer_canvas(canvas);
+        free(canvas);
+        canvas = NULL;
+    }
+    *resultat = canvas;
+    return erreur;
+}
+
+/**
+ * canvascii_creer - Crée un canevas vide.
+ *
+ * @param hauteur Nombre de rangées.
+ * @param largeur Nombre de colonnes.
+ * @param disposition DISPOSITION_TUILES et DISPOSITION_COMPACTE combinées, ou 0.
+ * @param canvas Reçoit le canevas, ou NULL en cas d'erreur.
+ * @return enum error OK, ERR_CANVAS_TOO_HIGH, ERR_CANVAS_TOO_WIDE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_creer(unsigned int hauteur, unsigned int largeur,
+                           unsigned int disposition, struct canvas **canvas) {
+    struct canvas *nouveau = calloc(1, sizeof(struct canvas));
+
+    *canvas = NULL;
+    if (nouveau == NULL) return ERR_OUT_OF_MEMORY;
+    nouveau->height = hauteur;
+    nouveau->width = largeur;
+    nouveau->tiled = (disposition & DISPOSITION_TUILES) != 0;
+    nouveau->packed = (disposition & DISPOSITION_COMPACTE) != 0;
+    return publier_canvas(nouveau, creer_canvas(nouveau, '7'), canvas);
+}
+
+/**
+ * canvascii_lire - Lit un canevas texte ou RLE sur un flux.
+ *
+ * Le format est reconnu au premier caractère, comme sur l'entrée
+ * standard de la ligne de commande. Le flux est lu jusqu'à sa fin.
+ *
+ * @param flux Flux à lire.
+ * @param disposition DISPOSITION_TUILES et DISPOSITION_COMPACTE combinées, ou 0.
+ * @param canvas Reçoit le canevas, ou NULL en cas d'erreur.
+ * @return enum error OK, ERR_WRONG_PIXEL, ERR_CANVAS_NON_RECTANGULAR,
+ * ERR_CANVAS_TOO_HIGH, ERR_CANVAS_TOO_WIDE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_lire(FILE *flux, unsigned int disposition, struct canvas **canvas) {
+    struct canvas *lu = calloc(1, sizeof(struct canvas));
+    int premier = getc(flux);
+    size_t octets_lus;
+    char pixel_invalide;
+    enum error erreur;
+
+    *canvas = NULL;
+    if (premier != EOF) ungetc(premier, flux);
+    if (lu == NULL) return ERR_OUT_OF_MEMORY;
+    lu->packed = (disposition & DISPOSITION_COMPACTE) != 0;
+    if (premier == 'R') {
+        lu->tiled = (disposition & DISPOSITION_TUILES) != 0;
+        erreur = lire_canvas_rle(flux, lu, &octets_lus, &pixel_invalide);
+    } else {
+        erreur = lire_canvas(flux, lu, &octets_lus, &pixel_invalide);
+        if (erreur == OK && (disposition & DISPOSITION_TUILES)) erreur = disposer_en_tuiles(lu);
+    }
+    lu->pen = '7';
+    return publier_canvas(lu, erreur, canvas);
+}
+
+/**
+ * canvascii_charger - Projette en mémoire un canevas binaire.
+ *
+ * @param chemin Chemin d'un fichier écrit par canvascii_enregistrer ou -o.
+ * @param canvas Reçoit le canevas, ou NULL en cas d'erreur.
+ * @return enum error OK, ERR_WITH_VALUE si le fichier est illisible ou
+ * invalide, ERR_CANVAS_TOO_HIGH, ERR_CANVAS_TOO_WIDE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_charger(const char *chemin, struct canvas **canvas) {
+    struct canvas *charge = calloc(1, sizeof(struct canvas));
+
+    *canvas = NULL;
+    if (charge == NULL) return ERR_OUT_OF_MEMORY;
+    enum error erreur = charger_canvas_binaire(charge, chemin);
+    charge->pen = '7';
+    return publier_canvas(charge, erreur, canvas);
+}
+
+/**
+ * canvascii_liberer - Libère un canevas et ses pixels.
+ *
+ * @param canvas Canevas à libérer, éventuellement NULL.
+ */
+void canvascii_liberer(struct canvas *canvas) {
+    if (canvas == NULL) return;
+    liberer_canvas(canvas);
+    free(canvas);
+}
+
+/**
+ * canvascii_hauteur - Retourne le nombre de rangées d'un canevas.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @return unsigned int Hauteur du canevas.
+ */
+unsigned int canvascii_hauteur(const struct canvas *canvas) {
+    return canvas->height;
+}
+
+/**
+ * canvascii_largeur - Retourne le nombre de colonnes d'un canevas.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @return unsigned int Largeur du canevas.
+ */
+unsigned int canvascii_largeur(const struct canvas *canvas) {
+    return canvas->width;
+}
+
+/**
+ * canvascii_pixel - Lit un pixel d'un canevas.
+ *
+ * La rangée d'un canevas RLE est d'abord décodée.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du pixel.
+ * @param colonne Colonne du pixel.
+ * @param pixel Reçoit le pixel, '.' ou de '0' à '7'.
+ * @return enum error OK, ou ERR_WITH_VALUE si le pixel est hors du canevas.
+ */
+enum error canvascii_pixel(struct canvas *canvas, unsigned int rangee, unsigned int colonne, char *pixel) {
+    if (rangee >= canvas->height || colonne >= canvas->width) return ERR_WITH_VALUE;
+
+    decoder_rangees(canvas, rangee, (long) rangee + 1);
+    if (canvas->packed) {
+        char paire[2];
+        deballer_pixels(paire, pixel_canvas(canvas, rangee, colonne & ~1u), 2);
+        *pixel = paire[colonne & 1];
+    } else {
+        *pixel = *pixel_canvas(canvas, rangee, colonne);
+    }
+    return OK;
+}
+
+/**
+ * canvascii_choisir_crayon - Change le crayon des tracés suivants.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param crayon Couleur, de '0' à '7'.
+ * @return enum error OK, ou ERR_WITH_VALUE si la couleur est invalide.
+ */
+enum error canvascii_choisir_crayon(struct canvas *canvas, char crayon) {
+    if (crayon < '0' || crayon > '7') return ERR_WITH_VALUE;
+    canvas->pen = crayon;
+    return OK;
+}
+
+/**
+ * canvascii_choisir_epaisseur - Change l'épaisseur des contours suivants (-w).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param epaisseur Épaisseur des rectangles, segments et cercles, 1 par défaut.
+ * @return enum error OK, ou ERR_WITH_VALUE si l'épaisseur est nulle ou trop grande.
+ */
+enum error canvascii_choisir_epaisseur(struct canvas *canvas, unsigned int epaisseur) {
+    if (epaisseur == 0 || epaisseur > INT_MAX) return ERR_WITH_VALUE;
+    canvas->epaisseur = epaisseur;
+    return OK;
+}
+
+/**
+ * canvascii_ligne_horizontale - Trace une rangée entière (-h).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée à tracer.
+ * @return enum error OK, ou ERR_WITH_VALUE si la rangée est hors du canevas.
+ */
+enum error canvascii_ligne_horizontale(struct canvas *canvas, unsigned int rangee) {
+    Commande commande = {.type = COMMANDE_HORIZONTALE, .parametres.indice = rangee};
+    return executer_commande(canvas, &commande);
+}
+
+/**
+ * canvascii_ligne_verticale - Trace une colonne entière (-v).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param colonne Colonne à tracer.
+ * @return enum error OK, ou ERR_WITH_VALUE si la colonne est hors du canevas.
+ */
+enum error canvascii_ligne_verticale(struct canvas *canvas, unsigned int colonne) {
+    Commande commande = {.type = COMMANDE_VERTICALE, .parametres.indice = colonne};
+    return executer_commande(canvas, &commande);
+}
+
+/**
+ * tracer_rectangle_public - Trace un rectangle, plein ou non, pour l'interface publique.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param type COMMANDE_RECTANGLE ou COMMANDE_RECTANGLE_PLEIN.
+ * @param rangee Rangée du coin supérieur gauche.
+ * @param colonne Colonne du coin supérieur gauche.
+ * @param hauteur Hauteur du rectangle.
+ * @param largeur Largeur du rectangle.
+ * @return enum error OK, ou ERR_WITH_VALUE si une dimension dépasse INT_MAX.
+ */
+enum error tracer_rectangle_public(struct canvas *canvas, enum type_commande type, int rangee, int colonne,
+                                   unsigned int hauteur, unsigned int largeur) {
+    Commande commande = {.type = type, .parametres.rectangle = {{colonne, rangee}, hauteur, largeur}};
+
+    if (hauteur > INT_MAX || largeur > INT_MAX) return ERR_WITH_VALUE;
+    return executer_commande(canvas, &commande);
+}
+
+/**
+ * canvascii_rectangle - Trace le contour d'un rectangle (-r).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du coin supérieur gauche.
+ * @param colonne Colonne du coin supérieur gauche.
+ * @param hauteur Hauteur du rectangle.
+ * @param largeur Largeur du rectangle.
+ * @return enum error OK, ou ERR_WITH_VALUE si une dimension dépasse INT_MAX.
+ */
+enum error canvascii_rectangle(struct canvas *canvas, int rangee, int colonne,
+                               unsigned int hauteur, unsigned int largeur) {
+    return tracer_rectangle_public(canvas, COMMANDE_RECTANGLE, rangee, colonne, hauteur, largeur);
+}
+
+/**
+ * canvascii_rectangle_plein - Trace un rectangle plein (-R).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du coin supérieur gauche.
+ * @param colonne Colonne du coin supérieur gauche.
+ * @param hauteur Hauteur du rectangle.
+ * @param largeur Largeur du rectangle.
+ * @return enum error OK, ou ERR_WITH_VALUE si une dimension dépasse INT_MAX.
+ */
+enum error canvascii_rectangle_plein(struct canvas *canvas, int rangee, int colonne,
+                                     unsigned int hauteur, unsigned int largeur) {
+    return tracer_rectangle_public(canvas, COMMANDE_RECTANGLE_PLEIN, rangee, colonne, hauteur, largeur);
+}
+
+/**
+ * canvascii_segment - Trace un segment discret (-l).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee1 Rangée de la première extrémité.
+ * @param colonne1 Colonne de la première extrémité.
+ * @param rangee2 Rangée de la seconde extrémité.
+ * @param colonne2 Colonne de la seconde extrémité.
+ * @return enum error OK, ou ERR_WITH_VALUE si l'écart entre les extrémités
+ * dépasse INT_MAX en rangée ou en colonne.
+ */
+enum error canvascii_segment(struct canvas *canvas, int rangee1, int colonne1, int rangee2, int colonne2) {
+    Commande commande = {.type = COMMANDE_SEGMENT,
+                         .parametres.segment = {{rangee1, colonne1}, {rangee2, colonne2}}};
+
+    if (!ecarts_representables(commande.parametres.segment.pointA, commande.parametres.segment.pointB)) {
+        return ERR_WITH_VALUE;
+    }
+    return executer_commande(canvas, &commande);
+}
+
+/**
+ * tracer_cercle_public - Trace un cercle ou un disque pour l'interface publique.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param type COMMANDE_CERCLE ou COMMANDE_DISQUE.
+ * @param rangee Rangée du centre.
+ * @param colonne Colonne du centre.
+ * @param rayon Rayon.
+ * @return enum error OK, ou ERR_WITH_VALUE si le rayon dépasse INT_MAX.
+ */
+enum error tracer_cercle_public(struct canvas *canvas, enum type_commande type, int rangee, int colonne,
+                                unsigned int rayon) {
+    Commande commande = {.type = type, .parametres.cercle = {rangee, colonne, rayon}};
+
+    if (rayon > INT_MAX) return ERR_WITH_VALUE;
+    return executer_commande(canvas, &commande);
+}
+
+/**
+ * canvascii_cercle - Trace un cercle (-c).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du centre.
+ * @param colonne Colonne du centre.
+ * @param rayon Rayon.
+ * @return enum error OK, ou ERR_WITH_VALUE si le rayon dépasse INT_MAX.
+ */
+enum error canvascii_cercle(struct canvas *canvas, int rangee, int colonne, unsigned int rayon) {
+    return tracer_cercle_public(canvas, COMMANDE_CERCLE, rangee, colonne, rayon);
+}
+
+/**
+ * canvascii_disque - Trace un disque plein (-C).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du centre.
+ * @param colonne Colonne du centre.
+ * @param rayon Rayon.
+ * @return enum error OK, ou ERR_WITH_VALUE si le rayon dépasse INT_MAX.
+ */
+enum error canvascii_disque(struct canvas *canvas, int rangee, int colonne, unsigned int rayon) {
+    return tracer_cercle_public(canvas, COMMANDE_DISQUE, rangee, colonne, rayon);
+}
+
+/**
+ * canvascii_remplir - Remplit la zone de même couleur autour d'un pixel (-F).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param rangee Rangée du point de départ.
+ * @param colonne Colonne du point de départ.
+ * @return enum error OK, ERR_WITH_VALUE si le point est hors du canevas,
+ * ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_remplir(struct canvas *canvas, unsigned int rangee, unsigned int colonne) {
+    Commande commande = {.type = COMMANDE_REMPLISSAGE};
+
+    if (rangee > INT_MAX || colonne > INT_MAX) return ERR_WITH_VALUE;
+    commande.parametres.germe = (Coordonnees) {(int) rangee, (int) colonne};
+    return executer_commande(canvas, &commande);
+}
+
+/**
+ * tracer_polygone_public - Trace une ligne brisée ou un polygone pour l'interface publique.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param type COMMANDE_POLYLIGNE, COMMANDE_POLYGONE ou COMMANDE_POLYGONE_PLEIN.
+ * @param sommets Rangée puis colonne de chaque sommet, à la suite.
+ * @param nombre Nombre de sommets.
+ * @return enum error OK, ERR_MISSING_VALUE s'il manque des sommets,
+ * ERR_WITH_VALUE si l'écart entre les extrémités d'un côté dépasse
+ * INT_MAX, ou ERR_OUT_OF_MEMORY.
+ */
+enum error tracer_polygone_public(struct canvas *canvas, enum type_commande type, const int *sommets,
+                                  unsigned int nombre) {
+    Commande commande = {.type = type, .parametres.polygone = {NULL, nombre}};
+    enum error erreur;
+
+    if (nombre < (type == COMMANDE_POLYLIGNE ? 2 : 3)) return ERR_MISSING_VALUE;
+    commande.parametres.polygone.sommets = malloc(nombre * sizeof(Coordonnees));
+    if (commande.parametres.polygone.sommets == NULL) return ERR_OUT_OF_MEMORY;
+    for (unsigned int i = 0; i < nombre; i++) {
+        commande.parametres.polygone.sommets[i] = (Coordonnees) {sommets[2 * i], sommets[2 * i + 1]};
+    }
+    erreur = cotes_representables(&commande.parametres.polygone, type != COMMANDE_POLYLIGNE)
+             ? executer_commande(canvas, &commande) : ERR_WITH_VALUE;
+    liberer_commande(&commande);
+    return erreur;
+}
+
+/**
+ * canvascii_polyligne - Trace une ligne brisée (-L).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param sommets Rangée puis colonne de chaque sommet, à la suite.
+ * @param nombre Nombre de sommets, au moins 2.
+ * @return enum error OK, ERR_MISSING_VALUE, ERR_WITH_VALUE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_polyligne(struct canvas *canvas, const int *sommets, unsigned int nombre) {
+    return tracer_polygone_public(canvas, COMMANDE_POLYLIGNE, sommets, nombre);
+}
+
+/**
+ * canvascii_polygone - Trace le contour d'un polygone (-P).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param sommets Rangée puis colonne de chaque sommet, à la suite.
+ * @param nombre Nombre de sommets, au moins 3.
+ * @return enum error OK, ERR_MISSING_VALUE, ERR_WITH_VALUE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_polygone(struct canvas *canvas, const int *sommets, unsigned int nombre) {
+    return tracer_polygone_public(canvas, COMMANDE_POLYGONE, sommets, nombre);
+}
+
+/**
+ * canvascii_polygone_plein - Trace un polygone plein, selon la règle pair-impair (-A).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param sommets Rangée puis colonne de chaque sommet, à la suite.
+ * @param nombre Nombre de sommets, au moins 3.
+ * @return enum error OK, ERR_MISSING_VALUE, ERR_WITH_VALUE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_polygone_plein(struct canvas *canvas, const int *sommets, unsigned int nombre) {
+    return tracer_polygone_public(canvas, COMMANDE_POLYGONE_PLEIN, sommets, nombre);
+}
+
+/**
+ * canvascii_appliquer - Applique une option de dessin écrite comme sur la ligne de commande.
+ *
+ * Par exemple, l'option "-r" et la valeur "1,2,3,4" tracent un
+ * rectangle. La valeur est copiée avant d'être analysée.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param option Option de dessin (-p, -w, -h, -v, -r, -l, -c, -R, -C, -F,
+ * -L, -P ou -A).
+ * @param valeur Valeur de l'option, éventuellement NULL.
+ * @return enum error OK, ERR_UNRECOGNIZED_OPTION, ERR_MISSING_VALUE,
+ * ERR_WITH_VALUE ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_appliquer(struct canvas *canvas, const char *option, const char *valeur) {
+    char *copie = valeur != NULL ? strdup(valeur) : NULL;
+    Commande commande;
+    enum error erreur;
+
+    if (valeur != NULL && copie == NULL) return ERR_OUT_OF_MEMORY;
+    erreur = analyser_commande((char *) option, copie, &commande);
+    if (erreur == OK) {
+        erreur = executer_commande(canvas, &commande);
+        liberer_commande(&commande);
+    }
+    free(copie);
+    return erreur;
+}
+
+/**
+ * canvascii_imprimer - Imprime un canevas sur un flux.
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param flux Flux de destination.
+ * @param format FORMAT_TEXTE, FORMAT_COULEUR ou FORMAT_RLE.
+ * @return enum error OK, ou ERR_WITH_VALUE si l'écriture a échoué.
+ */
+enum error canvascii_imprimer(struct canvas *canvas, FILE *flux, enum format_impression format) {
+    if (format == FORMAT_RLE) {
+        imprimer_canvas_rle(canvas, flux);
+    } else {
+        decoder_rangees(canvas, 0, canvas->height);
+        if (format == FORMAT_COULEUR) imprimer_canvas_couleur(canvas, flux);
+        else imprimer_canvas(canvas, flux);
+    }
+    return ferror(flux) ? ERR_WITH_VALUE : OK;
+}
+
+/**
+ * canvascii_enregistrer - Enregistre un canevas dans le format binaire (-o).
+ *
+ * @param canvas Pointeur vers le canevas.
+ * @param chemin Chemin du fichier, remplacé s'il existe.
+ * @return enum error OK, ERR_WITH_VALUE si le fichier ne peut être écrit,
+ * ou ERR_OUT_OF_MEMORY.
+ */
+enum error canvascii_enregistrer(struct canvas *canvas, const char *chemin) {
+    decoder_rangees(canvas, 0, canvas->height);
+    return enregistrer_canvas_binaire(canvas, chemin);
+}